@@ -1,9 +1,11 @@
 #version 330 core
 out vec4 FragColor;
 
+in vec4 vColor;
+
 uniform vec3 uColor;
 
 void main()
 {
-    FragColor = vec4(uColor, 1.0);
+    FragColor = vec4(uColor, 1.0) * vColor;
 }
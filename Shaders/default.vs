@@ -1,12 +1,15 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor; // Per-vertex tint (constant white when the mesh has none)
 
 uniform vec3 uOffset;
 uniform float uScale;
 
+out vec4 vColor;
+
 void main()
 {
     vec3 scaledPos = aPos * uScale + uOffset;
     gl_Position = vec4(scaledPos, 1.0);
+    vColor = aColor;
 }
- 
\ No newline at end of file
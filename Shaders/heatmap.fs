@@ -0,0 +1,35 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+
+uniform sampler2D uHeat;
+uniform float uMaxValue;
+uniform float uOpacity;
+
+// Blue -> cyan -> green -> yellow -> red
+vec3 colorMap(float t)
+{
+    const vec3 c0 = vec3(0.0, 0.0, 1.0);
+    const vec3 c1 = vec3(0.0, 1.0, 1.0);
+    const vec3 c2 = vec3(0.0, 1.0, 0.0);
+    const vec3 c3 = vec3(1.0, 1.0, 0.0);
+    const vec3 c4 = vec3(1.0, 0.0, 0.0);
+    float s = clamp(t, 0.0, 1.0) * 4.0;
+    if (s < 1.0) return mix(c0, c1, s);
+    if (s < 2.0) return mix(c1, c2, s - 1.0);
+    if (s < 3.0) return mix(c2, c3, s - 2.0);
+    return mix(c3, c4, s - 3.0);
+}
+
+void main()
+{
+    // Already blurred at heat texture resolution; bilinear upscale smooths the rest
+    float value = texture(uHeat, vUV).r;
+
+    float t = value / uMaxValue;
+    float alpha = smoothstep(0.02, 0.25, t) * uOpacity;
+    if (alpha <= 0.0)
+        discard; // Most of the screen is cold: skip the blend entirely
+    FragColor = vec4(colorMap(t), alpha);
+}
@@ -0,0 +1,10 @@
+#version 330 core
+out vec2 vUV;
+
+void main()
+{
+    // Full-screen triangle generated from gl_VertexID, no vertex buffer needed
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vUV = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+out float FragValue;
+
+in vec2 vUV;
+
+uniform sampler2D uHeat;
+uniform vec2 uStep; // One texel along the blur direction
+
+void main()
+{
+    // One axis of the separable 5-tap binomial blur (1 4 6 4 1) / 16
+    FragValue = (texture(uHeat, vUV - 2.0 * uStep).r
+               + 4.0 * texture(uHeat, vUV - uStep).r
+               + 6.0 * texture(uHeat, vUV).r
+               + 4.0 * texture(uHeat, vUV + uStep).r
+               + texture(uHeat, vUV + 2.0 * uStep).r) / 16.0;
+}
@@ -0,0 +1,15 @@
+#version 330 core
+out float FragValue;
+
+in float vWeight;
+
+void main()
+{
+    // Smooth radial falloff across the point sprite, summed by additive blending
+    vec2 d = gl_PointCoord * 2.0 - 1.0;
+    float r2 = dot(d, d);
+    if (r2 > 1.0)
+        discard;
+    float falloff = (1.0 - r2) * (1.0 - r2);
+    FragValue = vWeight * falloff;
+}
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in float aWeight;
+
+uniform float uPointSize;
+
+out float vWeight;
+
+void main()
+{
+    vWeight = aWeight;
+    gl_PointSize = uPointSize;
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;    // Per-vertex tint (constant white when the mesh has none)
+layout (location = 2) in vec2 iOffset;   // Per instance
+layout (location = 3) in float iScale;   // Per instance
+layout (location = 4) in vec4 iColor;    // Per instance
+
+out vec4 vColor;
+
+void main()
+{
+    gl_Position = vec4(aPos.xy * iScale + iOffset, aPos.z * iScale, 1.0);
+    vColor = iColor * aColor;
+}
@@ -0,0 +1,34 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vPos;
+flat in vec4 vGeometry;
+flat in vec2 vShape;
+in vec4 vColor;
+
+float capsuleDistance(vec2 p, vec2 a, vec2 b, float radius)
+{
+    vec2 pa = p - a;
+    vec2 ba = b - a;
+    float h = clamp(dot(pa, ba) / max(dot(ba, ba), 1e-12), 0.0, 1.0);
+    return length(pa - ba * h) - radius;
+}
+
+float roundedRectDistance(vec2 p, vec2 center, vec2 halfSize, float radius)
+{
+    vec2 q = abs(p - center) - halfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main()
+{
+    float d = vShape.y < 0.5 ? capsuleDistance(vPos, vGeometry.xy, vGeometry.zw, vShape.x)
+                             : roundedRectDistance(vPos, vGeometry.xy, vGeometry.zw, vShape.x);
+
+    // About one pixel of edge, centered on the boundary
+    float coverage = clamp(0.5 - d / max(fwidth(d), 1e-6), 0.0, 1.0);
+    if (coverage <= 0.0) {
+        discard;
+    }
+    FragColor = vec4(vColor.rgb, vColor.a * coverage);
+}
@@ -0,0 +1,38 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;   // Unit quad corner, -1..1
+layout (location = 1) in vec4 iGeometry; // Capsule: a.xy, b.xy; rounded rect: center.xy, half size.xy
+layout (location = 2) in vec2 iShape;    // x: radius, y: 0 = capsule, 1 = rounded rect
+layout (location = 3) in vec4 iColor;
+
+uniform vec2 uPixelSize; // NDC units per pixel
+
+out vec2 vPos;
+flat out vec4 vGeometry;
+flat out vec2 vShape;
+out vec4 vColor;
+
+void main()
+{
+    vec2 pad = uPixelSize * 1.5; // Room for the anti-aliased edge
+    float radius = iShape.x;
+    vec2 pos;
+    if (iShape.y < 0.5) {
+        // Quad stretched along the segment (a circle is a zero-length segment)
+        vec2 axis = iGeometry.zw - iGeometry.xy;
+        float halfLength = 0.5 * length(axis);
+        vec2 u = halfLength > 0.0 ? axis / (2.0 * halfLength) : vec2(1.0, 0.0);
+        vec2 v = vec2(-u.y, u.x);
+        radius = max(radius, 0.5 * length(v * uPixelSize)); // Never thinner than one pixel
+        vec2 center = 0.5 * (iGeometry.xy + iGeometry.zw);
+        pos = center + u * aCorner.x * (halfLength + radius + length(u * pad))
+                     + v * aCorner.y * (radius + length(v * pad));
+    } else {
+        pos = iGeometry.xy + aCorner * (iGeometry.zw + pad);
+    }
+
+    gl_Position = vec4(pos, 0.0, 1.0);
+    vPos = pos;
+    vGeometry = iGeometry;
+    vShape = vec2(radius, iShape.y);
+    vColor = iColor;
+}
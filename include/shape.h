@@ -5,23 +5,37 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include "../src/shader.h" // Assuming shader.h is in the parent directory of shape.h
+#include "../src/gl_resource.h"
+#include "../src/vertex_layout.h"
 
 class Shape
 {
 public:
     // Constructor to initialize shape properties and OpenGL buffers
+    // `vertices` are xyz floats and `vertexColors` optional rgb floats per vertex;
+    // both are packed into `layout` on upload and only the GPU copy is kept.
+    // Indices are stored as bytes/shorts when the mesh is small enough.
     Shape(const std::vector<float>& vertices,
           const std::vector<GLuint>& indices,
           glm::vec3 position,
           float size,
           glm::vec3 color,
-          GLenum drawMode = GL_TRIANGLES); // Default draw mode is triangles
+          GLenum drawMode = GL_TRIANGLES, // Default draw mode is triangles
+          const VertexLayout& layout = VertexLayout(),
+          const std::vector<float>& vertexColors = std::vector<float>());
 
     // Method to draw the shape using the provided shader
     void draw(Shader& shader);
 
-    // Destructor to clean up OpenGL resources
-    ~Shape();
+    // Move-only: the GL objects belong to exactly one Shape and are released
+    // through GlDeletionQueue when it is destroyed
+    Shape(Shape&&) = default;
+    Shape& operator=(Shape&&) = default;
+    Shape(const Shape&) = delete;
+    Shape& operator=(const Shape&) = delete;
+
+    // GPU bytes used by the vertex and index buffers
+    size_t bufferBytes() const { return vertexBytes + indexCount * IndexTypeSize(indexType); }
 
     // Public member variables for position, size, and color
     // These are made public so they can be directly modified for animation
@@ -30,18 +44,21 @@ public:
     glm::vec3 color; // Moved to public section
 
 private:
-    // OpenGL buffer IDs
-    GLuint VAO, VBO, EBO;
+    // OpenGL buffer objects
+    GlVertexArray VAO;
+    GlBuffer VBO, EBO;
 
-    // Store original vertex and index data for buffer setup
-    std::vector<float> vertices;
-    std::vector<GLuint> indices;
+    VertexLayout layout;
+    float positionScale; // Snorm16 meshes are stored divided by their extent
+    size_t vertexBytes;
+    GLsizei indexCount;
+    GLenum indexType;
 
     // Drawing mode
     GLenum drawMode;
 
     // Helper method to set up OpenGL VAO, VBO, and EBO
-    void setupBuffers();
+    void setupBuffers(const std::vector<float>& vertices, const std::vector<float>& vertexColors, const std::vector<GLuint>& indices);
 };
 
 #endif // SHAPE_H
@@ -0,0 +1,166 @@
+#include "alloc_tracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static const int TAG_COUNT = static_cast<int>(AllocTag::Count);
+
+// One cache line per tag so the simulation and render threads do not contend
+struct alignas(64) TagCounter {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+// Zero-initialized statics: safe to touch from operator new during static initialization
+static TagCounter counters[TAG_COUNT];
+static std::atomic<uint64_t> freeCount(0);
+static thread_local AllocTag threadTag = AllocTag::Other;
+
+static AllocCounts frameStart;
+static AllocCounts previousFrame;
+
+const char* AllocTagName(AllocTag tag)
+{
+    switch (tag) {
+        case AllocTag::Other: return "Other";
+        case AllocTag::Simulation: return "Simulation";
+        case AllocTag::Render: return "Render";
+        case AllocTag::UI: return "UI";
+        case AllocTag::Log: return "Log";
+        case AllocTag::Capture: return "Capture";
+        default: return "?";
+    }
+}
+
+uint64_t AllocCounts::totalAllocations() const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < TAG_COUNT; ++i) {
+        total += allocations[i];
+    }
+    return total;
+}
+
+uint64_t AllocCounts::totalBytes() const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < TAG_COUNT; ++i) {
+        total += bytes[i];
+    }
+    return total;
+}
+
+bool AllocTracker::enabled()
+{
+#ifdef PGLMS_DISABLE_ALLOC_TRACKING
+    return false;
+#else
+    return true;
+#endif
+}
+
+void AllocTracker::recordAllocation(size_t bytes)
+{
+    TagCounter& counter = counters[static_cast<int>(threadTag)];
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    counter.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocTracker::recordFree()
+{
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocCounts AllocTracker::totals()
+{
+    AllocCounts counts;
+    for (int i = 0; i < TAG_COUNT; ++i) {
+        counts.allocations[i] = counters[i].allocations.load(std::memory_order_relaxed);
+        counts.bytes[i] = counters[i].bytes.load(std::memory_order_relaxed);
+    }
+    counts.frees = freeCount.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void AllocTracker::markFrame()
+{
+    AllocCounts now = totals();
+    for (int i = 0; i < TAG_COUNT; ++i) {
+        previousFrame.allocations[i] = now.allocations[i] - frameStart.allocations[i];
+        previousFrame.bytes[i] = now.bytes[i] - frameStart.bytes[i];
+    }
+    previousFrame.frees = now.frees - frameStart.frees;
+    frameStart = now;
+}
+
+const AllocCounts& AllocTracker::lastFrame()
+{
+    return previousFrame;
+}
+
+AllocTag AllocTracker::setThreadTag(AllocTag tag)
+{
+    AllocTag previous = threadTag;
+    threadTag = tag;
+    return previous;
+}
+
+void* AllocTracker::imguiAlloc(size_t size, void*)
+{
+    AllocScope scope(AllocTag::UI);
+    recordAllocation(size);
+    return std::malloc(size);
+}
+
+void AllocTracker::imguiFree(void* ptr, void*)
+{
+    if (ptr) {
+        recordFree();
+    }
+    std::free(ptr);
+}
+
+// --- Global operator new/delete ---
+// Only the plain and array forms are replaced; the nothrow forms forward here
+// in the standard library, aligned forms are left untracked.
+
+#ifndef PGLMS_DISABLE_ALLOC_TRACKING
+
+void* operator new(size_t size)
+{
+    AllocTracker::recordAllocation(size);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p) {
+        AllocTracker::recordFree();
+    }
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+#endif
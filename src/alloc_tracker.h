@@ -0,0 +1,81 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap allocation accounting.
+// The global operator new/delete are replaced (alloc_tracker.cpp, unless built
+// with PGLMS_DISABLE_ALLOC_TRACKING) and every allocation is charged to the
+// calling thread's current AllocTag. ImGui is routed through the same counters
+// with imguiAlloc/imguiFree. Counting is two relaxed atomic adds per
+// allocation; nothing is stored per block.
+
+enum class AllocTag : uint8_t {
+    Other,
+    Simulation,
+    Render,
+    UI,
+    Log,
+    Capture,
+    Count
+};
+
+const char* AllocTagName(AllocTag tag);
+
+struct AllocCounts {
+    uint64_t allocations[static_cast<int>(AllocTag::Count)] = {};
+    uint64_t bytes[static_cast<int>(AllocTag::Count)] = {};
+    uint64_t frees = 0;
+
+    uint64_t totalAllocations() const;
+    uint64_t totalBytes() const;
+};
+
+class AllocTracker
+{
+public:
+    // False when the operator new hooks are compiled out (counts stay zero)
+    static bool enabled();
+
+    // Counters since program start (all threads)
+    static AllocCounts totals();
+
+    // Frame boundary on the render thread: lastFrame() becomes everything
+    // allocated (by any thread) since the previous markFrame()
+    static void markFrame();
+    static const AllocCounts& lastFrame();
+
+    // Current thread's tag; returns the previous one
+    static AllocTag setThreadTag(AllocTag tag);
+
+    // ImGui allocator hooks, charged to AllocTag::UI:
+    // ImGui::SetAllocatorFunctions(AllocTracker::imguiAlloc, AllocTracker::imguiFree)
+    // before ImGui::CreateContext()
+    static void* imguiAlloc(size_t size, void* userData);
+    static void imguiFree(void* ptr, void* userData);
+
+    // Used by the operator new/delete hooks
+    static void recordAllocation(size_t bytes);
+    static void recordFree();
+};
+
+// Charge allocations in the enclosing scope to `tag` (restores the previous tag on exit)
+class AllocScope
+{
+public:
+    explicit AllocScope(AllocTag tag) : previous(AllocTracker::setThreadTag(tag)) {}
+    ~AllocScope() { AllocTracker::setThreadTag(previous); }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocTag previous;
+};
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_SCOPE(tag) AllocScope ALLOC_CONCAT(allocScope_, __LINE__)(tag)
+
+#endif // ALLOC_TRACKER_H
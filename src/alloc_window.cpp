@@ -0,0 +1,78 @@
+#include "alloc_window.h"
+#include "imgui.h"
+#include "alloc_tracker.h"
+
+static const int HISTORY_FRAMES = 240;
+
+void DrawAllocationWindow(bool* open)
+{
+    static float history[HISTORY_FRAMES] = {};
+    static int historyHead = 0;
+    static uint64_t allocatingFrames = 0;
+    static uint64_t frames = 0;
+
+    // Sample every frame the window is open, collapsed or not; history and
+    // totals only cover those frames
+    const AllocCounts& frame = AllocTracker::lastFrame();
+    uint64_t frameAllocations = frame.totalAllocations();
+    history[historyHead] = static_cast<float>(frameAllocations);
+    historyHead = (historyHead + 1) % HISTORY_FRAMES;
+    ++frames;
+    if (frameAllocations > 0) {
+        ++allocatingFrames;
+    }
+
+    if (!ImGui::Begin("Allocations", open)) {
+        ImGui::End();
+        return;
+    }
+
+    if (!AllocTracker::enabled()) {
+        ImGui::TextDisabled("Allocation tracking is compiled out (PGLMS_DISABLE_ALLOC_TRACKING)");
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Last frame: %llu allocations, %llu bytes, %llu frees",
+                (unsigned long long)frameAllocations, (unsigned long long)frame.totalBytes(),
+                (unsigned long long)frame.frees);
+    ImGui::Text("Frames that allocated: %llu / %llu", (unsigned long long)allocatingFrames, (unsigned long long)frames);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Reset")) {
+        allocatingFrames = 0;
+        frames = 0;
+    }
+
+    float peak = 1.0f;
+    for (float value : history) {
+        peak = value > peak ? value : peak;
+    }
+    ImGui::PlotHistogram("##allocs", history, HISTORY_FRAMES, historyHead, "allocations / frame",
+                         0.0f, peak, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+
+    AllocCounts totals = AllocTracker::totals();
+    if (ImGui::BeginTable("allocTags", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Subsystem");
+        ImGui::TableSetupColumn("Allocs / frame");
+        ImGui::TableSetupColumn("Bytes / frame");
+        ImGui::TableSetupColumn("Total allocs");
+        ImGui::TableSetupColumn("Total bytes");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < static_cast<int>(AllocTag::Count); ++i) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(AllocTagName(static_cast<AllocTag>(i)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)frame.allocations[i]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)frame.bytes[i]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)totals.allocations[i]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)totals.bytes[i]);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
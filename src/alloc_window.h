@@ -0,0 +1,8 @@
+#ifndef ALLOC_WINDOW_H
+#define ALLOC_WINDOW_H
+
+// ImGui "Allocations" window: heap allocations of the last frame per
+// subsystem, a per-frame history and the running totals.
+void DrawAllocationWindow(bool* open);
+
+#endif // ALLOC_WINDOW_H
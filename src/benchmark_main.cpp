@@ -0,0 +1,506 @@
+// Benchmark suite: times the simulation step and the scene renderer on
+// synthetic grids of increasing size, so performance work can be measured
+// and regressions caught before they ship.
+//
+//   pglms_bench [--sizes 1000,10000,100000,1000000] [--steps N] [--frames N]
+//               [--dt SECONDS] [--seed S] [--width W] [--height H] [--heatmap]
+//               [--no-render] [--no-multidraw] [--policy RULE] [--profile]
+//               [--json out.json] [--baseline base.json] [--threshold PERCENT]
+//               [--assert-no-alloc]
+//
+// Per grid size it reports step time percentiles, heap allocations per step,
+// frame time percentiles, heap allocations and draw calls/triangles per frame.
+// --policy adds a shedding rule (see shed_policy.h) evaluated on every step,
+// so its cost shows up in the step times.
+// With --baseline every lower-is-better metric is compared against a previous
+// --json run and the exit code is 2 when any of them got worse by more than
+// --threshold. --assert-no-alloc exits with 3 when a steady-state step or
+// frame touched the heap.
+// Step and frame counts default to a budget that shrinks with the grid size;
+// the same seed always produces the same grids and the same simulation.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "alloc_tracker.h"
+#include "cli_args.h"
+#include "gl_features.h"
+#include "gl_resource.h"
+#include "headless_context.h"
+#include "profiler.h"
+#include "render_stats.h"
+#include "render_target.h"
+#include "scene_renderer.h"
+#include "shed_policy.h"
+#include "simulation.h"
+
+// --- Options ---
+
+struct BenchOptions {
+    std::vector<size_t> sizes = { 1000, 10000, 100000, 1000000 };
+    int steps = 0;  // 0: derive from the grid size
+    int frames = 0; // 0: derive from the grid size
+    double dt = 0.001; // 1 kHz, the rate of the simulation thread
+    uint64_t seed = 1;
+    int width = 960;
+    int height = 540;
+    bool heatmap = false;
+    bool render = true;
+    bool multiDraw = true; // --no-multidraw forces the GL 3.3 per-mesh path
+    std::string policy;    // Shedding rule; empty: none
+    std::shared_ptr<const ShedPolicy> shedPolicy; // Compiled from `policy` in main()
+    bool profile = false;
+    bool assertNoAlloc = false;
+    std::string json;
+    std::string baseline;
+    double threshold = 10.0; // Percent
+};
+
+static bool ParseSizes(const std::string& list, std::vector<size_t>& sizes)
+{
+    sizes.clear();
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t value = 0;
+        if (!ParseNumber(item.c_str(), value) || value == 0) {
+            return false;
+        }
+        sizes.push_back(value);
+    }
+    return !sizes.empty();
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (arg == "--sizes" && hasValue) {
+            if (!ParseSizes(argv[++i], options.sizes)) return false;
+        }
+        else if (arg == "--steps" && hasValue) valid = ParseNumber(argv[++i], options.steps);
+        else if (arg == "--frames" && hasValue) valid = ParseNumber(argv[++i], options.frames);
+        else if (arg == "--dt" && hasValue) valid = ParseNumber(argv[++i], options.dt);
+        else if (arg == "--seed" && hasValue) valid = ParseNumber(argv[++i], options.seed);
+        else if (arg == "--width" && hasValue) valid = ParseNumber(argv[++i], options.width);
+        else if (arg == "--height" && hasValue) valid = ParseNumber(argv[++i], options.height);
+        else if (arg == "--json" && hasValue) options.json = argv[++i];
+        else if (arg == "--baseline" && hasValue) options.baseline = argv[++i];
+        else if (arg == "--threshold" && hasValue) valid = ParseNumber(argv[++i], options.threshold);
+        else if (arg == "--heatmap") options.heatmap = true;
+        else if (arg == "--no-multidraw") options.multiDraw = false;
+        else if (arg == "--policy" && hasValue) options.policy = argv[++i];
+        else if (arg == "--no-render") options.render = false;
+        else if (arg == "--profile") options.profile = true;
+        else if (arg == "--assert-no-alloc") options.assertNoAlloc = true;
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+        if (!valid) {
+            std::cerr << "Bad value for " << arg << ": " << argv[i] << "\n";
+            return false;
+        }
+    }
+    return options.steps >= 0 && options.frames >= 0 && options.dt > 0.0 &&
+           options.width > 0 && options.height > 0 && options.threshold >= 0.0;
+}
+
+// --- Results ---
+
+struct BenchResult {
+    size_t zones = 0;
+    int steps = 0;
+    double firstStepMs = 0.0; // Includes the initial overload event
+    double stepP50Us = 0.0, stepP90Us = 0.0, stepP99Us = 0.0, stepMaxUs = 0.0;
+    double publishP50Us = 0.0;
+    double allocsPerStep = 0.0;
+    double bytesPerStep = 0.0;
+    int frames = 0;
+    double frameP50Ms = 0.0, frameP90Ms = 0.0, frameP99Ms = 0.0;
+    double allocsPerFrame = 0.0;
+    double drawCalls = 0.0;
+    double triangles = 0.0;
+};
+
+// Percentile of the nearest sample; sorts `samples`
+static double Percentile(std::vector<double>& samples, double p)
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[std::min(rank, samples.size() - 1)];
+}
+
+static double ElapsedUs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reported metrics, all lower-is-better. Noisy tail metrics are written out
+// but not gated against the baseline.
+struct MetricField {
+    const char* key;
+    double BenchResult::* value;
+    bool gated;
+    bool render; // Only measured when rendering is enabled
+};
+
+static const MetricField metricFields[] = {
+    { "first_step_ms", &BenchResult::firstStepMs, false, false },
+    { "step_p50_us", &BenchResult::stepP50Us, true, false },
+    { "step_p90_us", &BenchResult::stepP90Us, true, false },
+    { "step_p99_us", &BenchResult::stepP99Us, true, false },
+    { "step_max_us", &BenchResult::stepMaxUs, false, false },
+    { "publish_p50_us", &BenchResult::publishP50Us, true, false },
+    { "allocs_per_step", &BenchResult::allocsPerStep, true, false },
+    { "bytes_per_step", &BenchResult::bytesPerStep, true, false },
+    { "frame_p50_ms", &BenchResult::frameP50Ms, true, true },
+    { "frame_p90_ms", &BenchResult::frameP90Ms, true, true },
+    { "frame_p99_ms", &BenchResult::frameP99Ms, false, true },
+    { "allocs_per_frame", &BenchResult::allocsPerFrame, true, true },
+    { "draw_calls", &BenchResult::drawCalls, true, true },
+    { "triangles", &BenchResult::triangles, true, true },
+};
+
+// --- Benchmark runs ---
+
+static void BenchSimulation(const BenchOptions& options, const std::shared_ptr<const GridTopology>& topology,
+                            BenchResult& result)
+{
+    size_t zones = topology->zoneCount();
+    result.steps = options.steps > 0 ? options.steps
+                                     : static_cast<int>(std::clamp<size_t>(20000000 / zones, 50, 5000));
+    int warmup = std::max(1, result.steps / 10);
+
+    SimulationParams params;
+    params.shedPolicy = options.shedPolicy;
+    Simulation simulation(topology, options.seed, params);
+    SimSnapshot snapshot;
+
+    // Warm-up: first step (forced overload event), capacity growth in the log and snapshot
+    for (int i = 0; i < warmup; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        simulation.step(options.dt);
+        if (i == 0) {
+            result.firstStepMs = ElapsedUs(start) / 1000.0;
+        }
+        simulation.fillSnapshot(snapshot);
+    }
+
+    std::vector<double> stepUs;
+    std::vector<double> publishUs;
+    stepUs.reserve(result.steps);
+    publishUs.reserve(result.steps);
+    uint64_t stepAllocations = 0;
+    uint64_t stepBytes = 0;
+    for (int i = 0; i < result.steps; ++i) {
+        AllocCounts before = AllocTracker::totals();
+        auto start = std::chrono::steady_clock::now();
+        simulation.step(options.dt);
+        double elapsed = ElapsedUs(start);
+        AllocCounts after = AllocTracker::totals();
+        stepAllocations += after.totalAllocations() - before.totalAllocations();
+        stepBytes += after.totalBytes() - before.totalBytes();
+
+        start = std::chrono::steady_clock::now();
+        simulation.fillSnapshot(snapshot);
+        publishUs.push_back(ElapsedUs(start));
+        stepUs.push_back(elapsed);
+    }
+
+    result.stepP50Us = Percentile(stepUs, 50.0);
+    result.stepP90Us = Percentile(stepUs, 90.0);
+    result.stepP99Us = Percentile(stepUs, 99.0);
+    result.stepMaxUs = stepUs.back(); // Sorted by Percentile()
+    result.publishP50Us = Percentile(publishUs, 50.0);
+    result.allocsPerStep = static_cast<double>(stepAllocations) / result.steps;
+    result.bytesPerStep = static_cast<double>(stepBytes) / result.steps;
+}
+
+static void BenchRenderer(const BenchOptions& options, const std::shared_ptr<const GridTopology>& topology,
+                          BenchResult& result)
+{
+    size_t zones = topology->zoneCount();
+    result.frames = options.frames > 0 ? options.frames
+                                       : static_cast<int>(std::clamp<size_t>(600000 / zones, 3, 120));
+    int warmup = std::max(1, result.frames / 10);
+
+    // One simulation step gives a realistic mix of states (one zone overloaded)
+    Simulation simulation(topology, options.seed);
+    simulation.step(options.dt);
+    SimSnapshot snapshot;
+    simulation.fillSnapshot(snapshot);
+
+    RenderTarget target(options.width, options.height);
+    SceneRenderer renderer(*topology);
+    renderer.heatmapMode = options.heatmap;
+    renderer.multiDraw = renderer.multiDraw && options.multiDraw;
+    glClearColor(0.1f, 0.3f, 0.15f, 1.0f);
+
+    std::vector<double> frameMs;
+    frameMs.reserve(result.frames);
+    uint64_t drawCalls = 0;
+    uint64_t triangles = 0;
+    uint64_t frameAllocations = 0;
+    for (int frame = -warmup; frame < result.frames; ++frame) {
+        snapshot.time += 1.0 / 60.0; // Move the flow circles along; the draw cost is what we time
+
+        uint64_t allocations = AllocTracker::totals().totalAllocations();
+        auto start = std::chrono::steady_clock::now();
+        FrameRenderStats().reset();
+        target.bind();
+        glClear(GL_COLOR_BUFFER_BIT);
+        renderer.draw(snapshot);
+        glFinish(); // Include the GPU work in the measurement
+        double elapsed = ElapsedUs(start) / 1000.0;
+        GlDeletionQueue::drain();
+
+        if (frame >= 0) {
+            frameAllocations += AllocTracker::totals().totalAllocations() - allocations;
+            frameMs.push_back(elapsed);
+            drawCalls += FrameRenderStats().drawCalls;
+            triangles += FrameRenderStats().triangles;
+        }
+    }
+
+    result.frameP50Ms = Percentile(frameMs, 50.0);
+    result.frameP90Ms = Percentile(frameMs, 90.0);
+    result.frameP99Ms = Percentile(frameMs, 99.0);
+    result.allocsPerFrame = static_cast<double>(frameAllocations) / result.frames;
+    result.drawCalls = static_cast<double>(drawCalls) / result.frames;
+    result.triangles = static_cast<double>(triangles) / result.frames;
+}
+
+// --- JSON ---
+
+static bool WriteJson(const std::string& path, const BenchOptions& options, const std::string& backend,
+                      const std::vector<BenchResult>& results)
+{
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file.precision(12);
+    file << "{\n";
+    file << "  \"benchmark\": \"pglms\",\n";
+    file << "  \"version\": 1,\n";
+    file << "  \"seed\": " << options.seed << ",\n";
+    file << "  \"dt\": " << options.dt << ",\n";
+    file << "  \"width\": " << options.width << ",\n";
+    file << "  \"height\": " << options.height << ",\n";
+    file << "  \"heatmap\": " << (options.heatmap ? "true" : "false") << ",\n";
+    file << "  \"policy\": \"" << options.policy << "\",\n";
+    file << "  \"multidraw\": " << (options.multiDraw && GlSupport().multiDrawIndirect ? "true" : "false") << ",\n";
+    file << "  \"renderer\": \"" << backend << "\",\n";
+    file << "  \"results\": [\n";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const BenchResult& result = results[r];
+        file << "    { \"zones\": " << result.zones << ", \"steps\": " << result.steps
+             << ", \"frames\": " << result.frames;
+        for (const MetricField& field : metricFields) {
+            file << ", \"" << field.key << "\": " << result.*field.value;
+        }
+        file << " }" << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return static_cast<bool>(file);
+}
+
+// Reads back the flat result objects written by WriteJson (not a general JSON parser)
+static bool ReadBaseline(const std::string& path, std::vector<BenchResult>& results)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    size_t pos = text.find("\"results\"");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    while ((pos = text.find('{', pos)) != std::string::npos) {
+        size_t end = text.find('}', pos);
+        if (end == std::string::npos) {
+            return false;
+        }
+        BenchResult result;
+        size_t key = pos;
+        while ((key = text.find('"', key)) != std::string::npos && key < end) {
+            size_t keyEnd = text.find('"', key + 1);
+            std::string name = text.substr(key + 1, keyEnd - key - 1);
+            size_t colon = text.find(':', keyEnd);
+            double value = std::strtod(text.c_str() + colon + 1, nullptr);
+            if (name == "zones") result.zones = static_cast<size_t>(value);
+            else if (name == "steps") result.steps = static_cast<int>(value);
+            else if (name == "frames") result.frames = static_cast<int>(value);
+            for (const MetricField& field : metricFields) {
+                if (name == field.key) {
+                    result.*field.value = value;
+                }
+            }
+            key = text.find(',', colon);
+            if (key == std::string::npos || key > end) {
+                break;
+            }
+        }
+        results.push_back(result);
+        pos = end + 1;
+    }
+    return !results.empty();
+}
+
+// Prints every gated metric that got worse than the baseline by more than the threshold
+static int CompareWithBaseline(const std::vector<BenchResult>& results, const std::vector<BenchResult>& baseline,
+                               double threshold)
+{
+    int regressions = 0;
+    for (const BenchResult& result : results) {
+        const BenchResult* base = nullptr;
+        for (const BenchResult& candidate : baseline) {
+            if (candidate.zones == result.zones) {
+                base = &candidate;
+            }
+        }
+        if (!base) {
+            printf("  %zu zones: not in baseline\n", result.zones);
+            continue;
+        }
+        for (const MetricField& field : metricFields) {
+            double now = result.*field.value;
+            double before = base->*field.value;
+            if (!field.gated || (now == 0.0 && before == 0.0)) {
+                continue;
+            }
+            if (field.render && (result.frames == 0 || base->frames == 0)) {
+                continue; // Rendering skipped in one of the runs
+            }
+            double change = before > 0.0 ? (now - before) / before * 100.0 : 100.0;
+            if (change > threshold) {
+                printf("  REGRESSION %zu zones %-16s %12.3f -> %12.3f (%+.1f%%)\n",
+                       result.zones, field.key, before, now, change);
+                ++regressions;
+            }
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "usage: pglms_bench [--sizes 1000,10000,...] [--steps N] [--frames N] [--dt SECONDS]\n"
+                     "                   [--seed S] [--width W] [--height H] [--heatmap] [--no-render] [--no-multidraw]\n"
+                     "                   [--policy RULE] [--profile] [--json out.json] [--baseline base.json]\n"
+                     "                   [--threshold PERCENT] [--assert-no-alloc]\n";
+        return 1;
+    }
+    if (!options.policy.empty()) {
+        ShedPolicyConfig config;
+        config.rule = options.policy;
+        config.interval = 0.0; // Every step, so the step times include it
+        std::shared_ptr<ShedPolicy> policy = std::make_shared<ShedPolicy>();
+        std::string error;
+        if (!policy->compile(config, error)) {
+            std::cerr << "ERROR::BENCHMARK::POLICY_COMPILE_FAILED " << error << "\n";
+            return 1;
+        }
+        options.shedPolicy = policy;
+    }
+    if (options.assertNoAlloc && !AllocTracker::enabled()) {
+        std::cerr << "ERROR::BENCHMARK::ALLOC_TRACKING_DISABLED --assert-no-alloc needs allocation tracking\n";
+        return 1;
+    }
+
+    // The per-scope ring writes are cheap but not free; keep them out of the numbers unless asked
+    Profiler::enabled.store(options.profile);
+    Profiler::setThreadName("Benchmark");
+
+    HeadlessContext context;
+    std::string backend = "none";
+    if (options.render) {
+        if (context.create()) {
+            backend = context.description();
+            std::cout << backend << "\n";
+        } else {
+            std::cerr << "ERROR::BENCHMARK::NO_CONTEXT rendering benchmarks skipped\n";
+            options.render = false;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    printf("%10s %7s %9s %9s %9s %9s %10s %9s %6s %9s %9s %9s %9s %11s\n", "zones", "steps", "first ms",
+           "p50 us", "p90 us", "p99 us", "publish us", "allocs", "frames", "p50 ms", "p90 ms", "allocs", "draws",
+           "triangles");
+    for (size_t zones : options.sizes) {
+        BenchResult result;
+        result.zones = zones;
+        std::shared_ptr<const GridTopology> topology =
+            std::make_shared<GridTopology>(GridTopology::makeSynthetic(zones, options.seed));
+
+        BenchSimulation(options, topology, result);
+        if (options.render) {
+            BenchRenderer(options, topology, result);
+        }
+
+        printf("%10zu %7d %9.2f %9.1f %9.1f %9.1f %10.1f %9.2f %6d %9.2f %9.2f %9.2f %9.0f %11.0f\n",
+               result.zones, result.steps, result.firstStepMs, result.stepP50Us, result.stepP90Us, result.stepP99Us,
+               result.publishP50Us, result.allocsPerStep, result.frames, result.frameP50Ms, result.frameP90Ms,
+               result.allocsPerFrame, result.drawCalls, result.triangles);
+        fflush(stdout);
+        results.push_back(result);
+    }
+
+    int allocatingRuns = 0;
+    if (options.assertNoAlloc) {
+        for (const BenchResult& result : results) {
+            if (result.allocsPerStep > 0.0 || result.allocsPerFrame > 0.0) {
+                printf("ALLOCATION %zu zones: %.2f allocations/step, %.2f allocations/frame in steady state\n",
+                       result.zones, result.allocsPerStep, result.allocsPerFrame);
+                ++allocatingRuns;
+            }
+        }
+    }
+
+    if (!options.json.empty()) {
+        if (!WriteJson(options.json, options, backend, results)) {
+            std::cerr << "ERROR::BENCHMARK::WRITE_FAILED " << options.json << "\n";
+            return -1;
+        }
+        printf("Wrote results to %s\n", options.json.c_str());
+    }
+
+    if (!options.baseline.empty()) {
+        std::vector<BenchResult> baseline;
+        if (!ReadBaseline(options.baseline, baseline)) {
+            std::cerr << "ERROR::BENCHMARK::BASELINE_READ_FAILED " << options.baseline << "\n";
+            return -1;
+        }
+        printf("Comparing with %s (threshold %.1f%%)\n", options.baseline.c_str(), options.threshold);
+        int regressions = CompareWithBaseline(results, baseline, options.threshold);
+        if (regressions > 0) {
+            printf("%d regression(s)\n", regressions);
+            return 2;
+        }
+        printf("No regressions\n");
+    }
+    return allocatingRuns > 0 ? 3 : 0;
+}
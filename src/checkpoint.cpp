@@ -0,0 +1,243 @@
+#include "checkpoint.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PGLMS_CHECKPOINT_MMAP 1
+#endif
+
+static const char checkpointMagic[8] = { 'P', 'G', 'L', 'M', 'S', 'C', 'K', 'P' };
+static const size_t sectionAlignment = 64;
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t totalBytes;
+};
+
+struct CheckpointTableEntry {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+static size_t AlignUp(size_t offset)
+{
+    return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+}
+
+// --- CheckpointWriter ---
+
+void CheckpointWriter::add(CheckpointSection id, const void* data, size_t bytes)
+{
+    sections.push_back({ id, data, bytes, 0 });
+}
+
+void CheckpointWriter::addCopy(CheckpointSection id, const void* data, size_t bytes)
+{
+    sections.push_back({ id, nullptr, bytes, copies.size() });
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    copies.insert(copies.end(), source, source + bytes);
+}
+
+size_t CheckpointWriter::size() const
+{
+    size_t offset = sizeof(CheckpointHeader) + sections.size() * sizeof(CheckpointTableEntry);
+    for (const Section& section : sections) {
+        offset = AlignUp(offset) + section.bytes;
+    }
+    return offset;
+}
+
+void CheckpointWriter::writeTo(uint8_t* out) const
+{
+    const size_t total = size();
+    std::memset(out, 0, total); // Padding stays zero, so equal states give equal files
+
+    CheckpointHeader header;
+    std::memcpy(header.magic, checkpointMagic, sizeof(header.magic));
+    header.version = checkpointVersion;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.totalBytes = total;
+    std::memcpy(out, &header, sizeof(header));
+
+    size_t offset = sizeof(CheckpointHeader) + sections.size() * sizeof(CheckpointTableEntry);
+    for (size_t s = 0; s < sections.size(); ++s) {
+        offset = AlignUp(offset);
+        CheckpointTableEntry entry = { static_cast<uint32_t>(sections[s].id), 0, offset, sections[s].bytes };
+        std::memcpy(out + sizeof(CheckpointHeader) + s * sizeof(entry), &entry, sizeof(entry));
+        if (sections[s].bytes > 0) {
+            const void* data = sections[s].data ? sections[s].data : &copies[sections[s].copyOffset];
+            std::memcpy(out + offset, data, sections[s].bytes);
+        }
+        offset += sections[s].bytes;
+    }
+}
+
+void CheckpointWriter::write(std::vector<uint8_t>& out) const
+{
+    out.resize(size());
+    writeTo(out.data());
+}
+
+bool CheckpointWriter::writeFile(const std::string& path) const
+{
+    std::vector<uint8_t> bytes;
+    write(bytes);
+    FILE* file = std::fopen(path.c_str(), "wb");
+    bool written = file && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    if (file && std::fclose(file) != 0) {
+        written = false;
+    }
+    if (!written) {
+        std::cerr << "ERROR::CHECKPOINT::FILE_NOT_WRITTEN " << path << "\n";
+    }
+    return written;
+}
+
+// --- CheckpointReader ---
+
+CheckpointReader::CheckpointReader()
+    : base(nullptr), totalBytes(0), sectionCount(0), mapping(nullptr), mappingSize(0)
+{
+}
+
+CheckpointReader::~CheckpointReader()
+{
+    close();
+}
+
+void CheckpointReader::close()
+{
+#ifdef PGLMS_CHECKPOINT_MMAP
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    fileData.clear();
+    base = nullptr;
+    totalBytes = 0;
+    sectionCount = 0;
+}
+
+bool CheckpointReader::open(const uint8_t* data, size_t size)
+{
+    CheckpointHeader header;
+    if (size < sizeof(header)) {
+        std::cerr << "ERROR::CHECKPOINT::TRUNCATED\n";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, checkpointMagic, sizeof(header.magic)) != 0) {
+        std::cerr << "ERROR::CHECKPOINT::NOT_A_CHECKPOINT\n";
+        return false;
+    }
+    if (header.version != checkpointVersion) {
+        std::cerr << "ERROR::CHECKPOINT::UNSUPPORTED_VERSION " << header.version << " (expected " << checkpointVersion << ")\n";
+        return false;
+    }
+    if (header.totalBytes != size ||
+        header.sectionCount > (size - sizeof(header)) / sizeof(CheckpointTableEntry)) {
+        std::cerr << "ERROR::CHECKPOINT::TRUNCATED\n";
+        return false;
+    }
+    for (uint32_t s = 0; s < header.sectionCount; ++s) {
+        CheckpointTableEntry entry;
+        std::memcpy(&entry, data + sizeof(header) + s * sizeof(entry), sizeof(entry));
+        if (entry.offset > size || entry.bytes > size - entry.offset) {
+            std::cerr << "ERROR::CHECKPOINT::BAD_SECTION " << entry.id << "\n";
+            return false;
+        }
+    }
+    base = data;
+    totalBytes = size;
+    sectionCount = header.sectionCount;
+    return true;
+}
+
+bool CheckpointReader::openFile(const std::string& path)
+{
+    close();
+#ifdef PGLMS_CHECKPOINT_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "ERROR::CHECKPOINT::FILE_NOT_READ " << path << "\n";
+            return false;
+        }
+        mapping = mapped;
+        mappingSize = static_cast<size_t>(info.st_size);
+        if (!open(static_cast<const uint8_t*>(mapping), mappingSize)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#else
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file) {
+        std::fseek(file, 0, SEEK_END);
+        long length = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        if (length > 0) {
+            fileData.resize(static_cast<size_t>(length));
+            bool complete = std::fread(fileData.data(), 1, fileData.size(), file) == fileData.size();
+            std::fclose(file);
+            if (complete && open(fileData.data(), fileData.size())) {
+                return true;
+            }
+            close();
+            return false;
+        }
+        std::fclose(file);
+    }
+#endif
+    std::cerr << "ERROR::CHECKPOINT::FILE_NOT_READ " << path << "\n";
+    return false;
+}
+
+const uint8_t* CheckpointReader::find(CheckpointSection id, size_t& bytes) const
+{
+    for (uint32_t s = 0; s < sectionCount; ++s) {
+        CheckpointTableEntry entry;
+        std::memcpy(&entry, base + sizeof(CheckpointHeader) + s * sizeof(entry), sizeof(entry));
+        if (entry.id == static_cast<uint32_t>(id)) {
+            bytes = static_cast<size_t>(entry.bytes);
+            return base + entry.offset;
+        }
+    }
+    return nullptr;
+}
+
+size_t CheckpointReader::sectionSize(CheckpointSection id) const
+{
+    size_t bytes = 0;
+    return find(id, bytes) ? bytes : SIZE_MAX;
+}
+
+bool CheckpointReader::read(CheckpointSection id, void* out, size_t bytes) const
+{
+    size_t stored = 0;
+    const uint8_t* data = find(id, stored);
+    if (!data || stored != bytes) {
+        return false;
+    }
+    if (bytes > 0) {
+        std::memcpy(out, data, bytes);
+    }
+    return true;
+}
@@ -0,0 +1,119 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Versioned container for simulation checkpoints (see
+// Simulation::saveCheckpoint). A checkpoint is a set of raw arrays, one per
+// section, laid out so it can be mapped straight from disk:
+//
+//   header       char magic[8] "PGLMSCKP", uint32 version, uint32 sectionCount, uint64 totalBytes
+//   table        sectionCount x { uint32 id, uint32 reserved, uint64 offset, uint64 bytes }
+//   sections     each at a 64-byte aligned offset from the start
+//
+// Arrays are stored in host byte order exactly as they sit in memory, so a
+// restore is one memcpy per SoA array. A change to what a section holds (or to
+// a struct stored in one) needs a new checkpointVersion; older files are refused.
+
+static const uint32_t checkpointVersion = 1;
+
+enum class CheckpointSection : uint32_t {
+    SimulationScalars = 1,
+    ZoneLoad,
+    ZoneState,
+    ZoneStateChangeTime,
+    ZonePrompt,
+    ZoneManualCut,
+
+    FlowScalars = 32,
+    FlowStart,
+    FlowEnd,
+    FlowDuration,
+    FlowDelay,
+    FlowTarget,
+    FlowGeneration,
+    FlowLivePosition,
+    FlowNextFree,
+    FlowZoneNext,
+    FlowZonePrev,
+    FlowLive,
+    FlowZoneHead
+};
+
+class CheckpointWriter
+{
+public:
+    // The data is referenced, not copied: it must stay unchanged until the
+    // checkpoint is written
+    void add(CheckpointSection id, const void* data, size_t bytes);
+
+    template <typename T>
+    void addArray(CheckpointSection id, const std::vector<T>& values)
+    {
+        add(id, values.data(), values.size() * sizeof(T));
+    }
+
+    // Copied into the writer: for small structs assembled on the spot
+    void addCopy(CheckpointSection id, const void* data, size_t bytes);
+
+    size_t size() const; // Bytes of the finished checkpoint
+    void write(std::vector<uint8_t>& out) const;
+    // False (after printing the reason) if the file cannot be written
+    bool writeFile(const std::string& path) const;
+
+private:
+    struct Section {
+        CheckpointSection id;
+        const void* data; // nullptr: at copyOffset in `copies`
+        size_t bytes;
+        size_t copyOffset;
+    };
+    void writeTo(uint8_t* out) const;
+
+    std::vector<Section> sections;
+    std::vector<uint8_t> copies;
+};
+
+class CheckpointReader
+{
+public:
+    CheckpointReader();
+    ~CheckpointReader();
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    // Read a checkpoint held in memory (not copied; it must outlive the
+    // reader). False (after printing the reason) if it is not a valid checkpoint.
+    bool open(const uint8_t* data, size_t size);
+    // Map the file (read into memory where mmap is unavailable)
+    bool openFile(const std::string& path);
+    void close();
+
+    // Size of a section, or SIZE_MAX if the checkpoint does not have it
+    size_t sectionSize(CheckpointSection id) const;
+    bool has(CheckpointSection id, size_t bytes) const { return sectionSize(id) == bytes; }
+
+    // Copy a section into `out`; false if its size is not exactly `bytes`
+    bool read(CheckpointSection id, void* out, size_t bytes) const;
+
+    template <typename T>
+    bool readArray(CheckpointSection id, std::vector<T>& values) const
+    {
+        return read(id, values.data(), values.size() * sizeof(T));
+    }
+
+private:
+    const uint8_t* find(CheckpointSection id, size_t& bytes) const;
+
+    const uint8_t* base;
+    size_t totalBytes;
+    uint32_t sectionCount;
+    void* mapping;      // mmap of the file, if openFile() mapped one
+    size_t mappingSize;
+    std::vector<uint8_t> fileData; // Where the file was read instead
+};
+
+#endif // CHECKPOINT_H
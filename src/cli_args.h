@@ -0,0 +1,25 @@
+#ifndef CLI_ARGS_H
+#define CLI_ARGS_H
+
+#include <charconv>
+#include <cstring>
+#include <system_error>
+
+// Parse all of `text` as a number for the command-line tools. False (value
+// untouched) on an empty string, trailing characters, a sign an unsigned type
+// cannot hold, or a value out of range, so ParseOptions() can print the usage
+// line instead of throwing like std::stoi.
+template <typename T>
+bool ParseNumber(const char* text, T& value)
+{
+    const char* end = text + std::strlen(text);
+    T parsed;
+    std::from_chars_result result = std::from_chars(text, end, parsed);
+    if (result.ec != std::errc() || result.ptr != end || end == text) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+#endif // CLI_ARGS_H
@@ -0,0 +1,545 @@
+#include "control_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "profiler.h"
+
+static const size_t maxRequestSize = 64;          // Largest client frame (after the length)
+static const size_t maxInputBytes = 64u << 10;    // Per client; unread requests beyond it stay in the socket
+static const size_t maxBacklogBytes = 8u << 20;   // Per client; deltas coalesce and requests wait beyond it
+static const int maxEvents = 64;
+
+// --- Frame encoding ---
+
+template <typename T>
+static void Put(std::vector<uint8_t>& out, T value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static void PutAt(std::vector<uint8_t>& out, size_t offset, T value)
+{
+    std::memcpy(&out[offset], &value, sizeof(T));
+}
+
+// Start a frame and return its offset; EndFrame() fills in the length
+static size_t BeginFrame(std::vector<uint8_t>& out, ControlMessage type)
+{
+    size_t start = out.size();
+    Put<uint32_t>(out, 0);
+    Put<uint8_t>(out, static_cast<uint8_t>(type));
+    return start;
+}
+
+static void EndFrame(std::vector<uint8_t>& out, size_t start)
+{
+    PutAt<uint32_t>(out, start, static_cast<uint32_t>(out.size() - start - sizeof(uint32_t)));
+}
+
+static bool BacklogFull(const std::vector<uint8_t>& output, size_t sent)
+{
+    return output.size() - sent > maxBacklogBytes;
+}
+
+// --- ControlServer ---
+
+ControlServer::ControlServer(Simulation& simulation, SnapshotCodecParams packed)
+    : simulation(simulation), latest(nullptr), lastSentStep(0), encoder(packed), packedEntries(0),
+      packedKeyframeReady(false), listenFd(-1), epollFd(-1), wakeFd(-1),
+      running(false), connectionCount(0), commandCount(0), zoneUpdateCount(0), bytesSentCount(0), coalescedCount(0)
+{
+    // Every slot starts out valid so the first acquire() is usable
+    for (int i = 0; i < 3; ++i) {
+        simulation.fillSnapshot(snapshots.slot(i));
+    }
+}
+
+ControlServer::~ControlServer()
+{
+    stop();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+}
+
+bool ControlServer::start(const std::string& socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "ERROR::CONTROL::SOCKET_PATH_TOO_LONG " << socketPath << "\n";
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(socketPath.c_str());
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, 16) != 0) {
+        std::cerr << "ERROR::CONTROL::LISTEN_FAILED " << socketPath << ": " << std::strerror(errno) << "\n";
+        stop();
+        return false;
+    }
+    path = socketPath;
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (wakeFd < 0) {
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC); // Kept across restarts
+    }
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    bool watched = epollFd >= 0 && wakeFd >= 0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+    event.data.fd = wakeFd;
+    watched = watched && epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) == 0;
+    if (!watched) {
+        std::cerr << "ERROR::CONTROL::EPOLL_FAILED " << std::strerror(errno) << "\n";
+        stop();
+        return false;
+    }
+
+    running.store(true);
+    thread = std::thread(&ControlServer::run, this);
+    return true;
+}
+
+void ControlServer::stop()
+{
+    if (running.exchange(false)) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+        thread.join();
+    }
+    for (auto& entry : clients) {
+        close(entry.first);
+    }
+    clients.clear();
+    for (int* fd : { &listenFd, &epollFd }) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    if (!path.empty()) {
+        unlink(path.c_str());
+        path.clear();
+    }
+}
+
+void ControlServer::publish(const Simulation& source)
+{
+    source.fillSnapshot(snapshots.writeSlot());
+    snapshots.publish();
+    if (running.load(std::memory_order_acquire)) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one)); // Never blocks: the counter just grows
+        (void)written;
+    }
+}
+
+ControlServerStats ControlServer::stats() const
+{
+    ControlServerStats result;
+    result.connections = connectionCount.load(std::memory_order_relaxed);
+    result.commands = commandCount.load(std::memory_order_relaxed);
+    result.zoneUpdates = zoneUpdateCount.load(std::memory_order_relaxed);
+    result.bytesSent = bytesSentCount.load(std::memory_order_relaxed);
+    result.coalescedTicks = coalescedCount.load(std::memory_order_relaxed);
+    return result;
+}
+
+// --- Server thread ---
+
+void ControlServer::run()
+{
+    Profiler::setThreadName("Control server");
+    latest = &snapshots.acquire();
+    lastSentStep = latest->step;
+
+    epoll_event events[maxEvents];
+    while (running.load(std::memory_order_relaxed)) {
+        int count = epoll_wait(epollFd, events, maxEvents, -1);
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "ERROR::CONTROL::EPOLL_WAIT_FAILED " << std::strerror(errno) << "\n";
+            return;
+        }
+        for (int e = 0; e < count; ++e) {
+            int fd = events[e].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            if (fd == wakeFd) {
+                uint64_t ticks;
+                ssize_t drained = read(wakeFd, &ticks, sizeof(ticks));
+                (void)drained;
+                sendUpdates();
+                continue;
+            }
+
+            auto found = clients.find(fd);
+            if (found == clients.end()) {
+                continue; // Closed earlier in this batch
+            }
+            Client& client = *found->second;
+            bool open = !(events[e].events & (EPOLLHUP | EPOLLERR));
+            if (open && (events[e].events & EPOLLIN)) {
+                open = readClient(client);
+            }
+            if (open) {
+                open = flush(client);
+            }
+            if (open && !client.input.empty()) {
+                open = handleInput(client) && flush(client); // Requests held back while the backlog was full
+            }
+            if (!open) {
+                closeClient(fd);
+            }
+        }
+    }
+}
+
+void ControlServer::acceptClients()
+{
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN: no more pending connections
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        std::unique_ptr<Client> client(new Client());
+        client->fd = fd;
+        client->events = event.events;
+        clients[fd] = std::move(client);
+        connectionCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// False when the connection should be closed
+bool ControlServer::readClient(Client& client)
+{
+    uint8_t buffer[4096];
+    bool closing = false; // Frames that arrived before a hang-up are still handled
+    while (client.input.size() < maxInputBytes) {
+        size_t room = std::min(sizeof(buffer), maxInputBytes - client.input.size());
+        ssize_t received = recv(client.fd, buffer, room, 0);
+        if (received > 0) {
+            client.input.insert(client.input.end(), buffer, buffer + received);
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        closing = !(received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+        break;
+    }
+
+    bool open = handleInput(client);
+    if (closing && open) {
+        flush(client); // Best effort: answers to the last requests
+    }
+    return open && !closing;
+}
+
+// Handle the complete frames in the input buffer until the send backlog is
+// full; the rest wait there until flush() has drained it. False when the
+// connection should be closed
+bool ControlServer::handleInput(Client& client)
+{
+    size_t offset = 0;
+    bool open = true;
+    while (open && !BacklogFull(client.output, client.outputSent) && client.input.size() - offset >= sizeof(uint32_t)) {
+        uint32_t length;
+        std::memcpy(&length, &client.input[offset], sizeof(length));
+        if (length == 0 || length > maxRequestSize) {
+            size_t start = BeginFrame(client.output, ControlMessage::Error);
+            const char* message = "Bad frame length";
+            client.output.insert(client.output.end(), message, message + std::strlen(message));
+            EndFrame(client.output, start);
+            flush(client);
+            return false;
+        }
+        if (client.input.size() - offset < sizeof(uint32_t) + length) {
+            break; // Rest of the frame not here yet
+        }
+        const uint8_t* frame = &client.input[offset + sizeof(uint32_t)];
+        open = handleFrame(client, static_cast<ControlMessage>(frame[0]), frame + 1, length - 1);
+        offset += sizeof(uint32_t) + length;
+    }
+    client.input.erase(client.input.begin(), client.input.begin() + offset);
+    return open;
+}
+
+bool ControlServer::handleFrame(Client& client, ControlMessage type, const uint8_t* payload, size_t size)
+{
+    const char* error = nullptr;
+    switch (type) {
+        case ControlMessage::QueryZones:
+            appendStates(client, *latest);
+            return true;
+
+        case ControlMessage::Command: {
+            if (size != sizeof(uint8_t) + sizeof(int32_t) || payload[0] > static_cast<uint8_t>(SimCommandType::DeclineCut)) {
+                error = "Bad command";
+                break;
+            }
+            int32_t zone;
+            std::memcpy(&zone, payload + 1, sizeof(zone));
+            bool accepted = simulation.postCommand({ static_cast<SimCommandType>(payload[0]), zone });
+            commandCount.fetch_add(1, std::memory_order_relaxed);
+            size_t start = BeginFrame(client.output, ControlMessage::CommandAck);
+            Put<uint8_t>(client.output, accepted ? 1 : 0);
+            EndFrame(client.output, start);
+            return true;
+        }
+
+        case ControlMessage::Subscribe:
+            if (size != sizeof(float)) {
+                error = "Bad subscription";
+                break;
+            }
+            std::memcpy(&client.deadband, payload, sizeof(float));
+            client.subscribed = true;
+            appendStates(client, *latest); // Deltas are relative to this
+            return true;
+
+        case ControlMessage::SubscribePacked:
+            if (size != 0) {
+                error = "Bad subscription";
+                break;
+            }
+            client.packed = true;
+            client.packedSynced = false; // Starts with a keyframe on the next tick
+            return true;
+
+        case ControlMessage::Unsubscribe:
+            client.subscribed = false;
+            client.packed = false;
+            return true;
+
+        default:
+            error = "Unknown message type";
+            break;
+    }
+
+    size_t start = BeginFrame(client.output, ControlMessage::Error);
+    client.output.insert(client.output.end(), error, error + std::strlen(error));
+    EndFrame(client.output, start);
+    flush(client);
+    return false;
+}
+
+void ControlServer::sendUpdates()
+{
+    PROFILE_SCOPE("Control server tick");
+    latest = &snapshots.acquire();
+    if (latest->step == lastSentStep) {
+        return;
+    }
+    lastSentStep = latest->step;
+
+    for (auto& entry : clients) {
+        if (entry.second->packed) {
+            encodePacked(); // Once per tick, for all packed subscribers
+            break;
+        }
+    }
+
+    std::vector<int> closed;
+    for (auto& entry : clients) {
+        Client& client = *entry.second;
+        if (!client.subscribed && !client.packed) {
+            continue;
+        }
+        if (BacklogFull(client.output, client.outputSent)) {
+            coalescedCount.fetch_add(1, std::memory_order_relaxed); // Caught up by a later delta
+            client.packedSynced = false; // Missed a packed delta: resync with a keyframe
+            continue;
+        }
+        if (client.subscribed) {
+            appendDeltas(client, *latest);
+        }
+        if (client.packed) {
+            appendPacked(client);
+        }
+        if (!flush(client)) {
+            closed.push_back(entry.first);
+        }
+    }
+    for (int fd : closed) {
+        closeClient(fd);
+    }
+}
+
+void ControlServer::appendStates(Client& client, const SimSnapshot& snapshot)
+{
+    const uint32_t count = static_cast<uint32_t>(snapshot.state.size());
+    std::vector<uint8_t>& out = client.output;
+    size_t start = BeginFrame(out, ControlMessage::ZoneStates);
+    Put<uint64_t>(out, snapshot.step);
+    Put<double>(out, snapshot.time);
+    Put<uint32_t>(out, count);
+    const uint8_t* states = reinterpret_cast<const uint8_t*>(snapshot.state.data());
+    out.insert(out.end(), states, states + count);
+    const uint8_t* loads = reinterpret_cast<const uint8_t*>(snapshot.currentLoad.data());
+    out.insert(out.end(), loads, loads + count * sizeof(float));
+    EndFrame(out, start);
+
+    client.sentState.assign(snapshot.state.begin(), snapshot.state.end());
+    client.sentLoad.assign(snapshot.currentLoad.begin(), snapshot.currentLoad.end());
+    zoneUpdateCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ControlServer::appendDeltas(Client& client, const SimSnapshot& snapshot)
+{
+    const size_t count = snapshot.state.size();
+    if (client.sentState.size() != count) {
+        appendStates(client, snapshot);
+        return;
+    }
+
+    // Worst case every zone, so the entries can be written without growing per zone
+    std::vector<uint8_t>& out = client.output;
+    const size_t entrySize = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(float);
+    size_t start = BeginFrame(out, ControlMessage::ZoneDeltas);
+    Put<uint64_t>(out, snapshot.step);
+    Put<double>(out, snapshot.time);
+    size_t countOffset = out.size();
+    Put<uint32_t>(out, 0);
+    size_t entriesOffset = out.size();
+    out.resize(entriesOffset + count * entrySize);
+
+    uint8_t* entry = &out[entriesOffset];
+    uint32_t changed = 0;
+    const float deadband = client.deadband;
+    for (size_t i = 0; i < count; ++i) {
+        HouseState state = snapshot.state[i];
+        float load = snapshot.currentLoad[i];
+        if (state == client.sentState[i] && std::fabs(load - client.sentLoad[i]) <= deadband) {
+            continue;
+        }
+        uint32_t zone = static_cast<uint32_t>(i);
+        std::memcpy(entry, &zone, sizeof(zone));
+        entry[sizeof(zone)] = static_cast<uint8_t>(state);
+        std::memcpy(entry + sizeof(zone) + 1, &load, sizeof(load));
+        entry += entrySize;
+        client.sentState[i] = state;
+        client.sentLoad[i] = load;
+        ++changed;
+    }
+
+    if (changed == 0) {
+        out.resize(start); // Nothing to say this tick
+        return;
+    }
+    out.resize(entriesOffset + changed * entrySize);
+    PutAt<uint32_t>(out, countOffset, changed);
+    EndFrame(out, start);
+    zoneUpdateCount.fetch_add(changed, std::memory_order_relaxed);
+}
+
+void ControlServer::encodePacked()
+{
+    packedFrame.clear();
+    size_t start = BeginFrame(packedFrame, ControlMessage::PackedSnapshot);
+    packedEntries = encoder.encode(*latest, packedFrame);
+    EndFrame(packedFrame, start);
+    packedKeyframeReady = false;
+}
+
+void ControlServer::appendPacked(Client& client)
+{
+    const std::vector<uint8_t>* frame = &packedFrame;
+    size_t entries = packedEntries;
+    if (!client.packedSynced && !encoder.lastWasKeyframe()) {
+        // The delta would not apply: send the state it leads to instead
+        if (!packedKeyframeReady) {
+            packedKeyframe.clear();
+            size_t start = BeginFrame(packedKeyframe, ControlMessage::PackedSnapshot);
+            encoder.appendKeyframe(packedKeyframe);
+            EndFrame(packedKeyframe, start);
+            packedKeyframeReady = true;
+        }
+        frame = &packedKeyframe;
+        entries = latest->state.size();
+    }
+    client.output.insert(client.output.end(), frame->begin(), frame->end());
+    client.packedSynced = true;
+    zoneUpdateCount.fetch_add(entries, std::memory_order_relaxed);
+}
+
+// Send as much pending output as the socket takes; false on a dead connection
+bool ControlServer::flush(Client& client)
+{
+    while (client.outputSent < client.output.size()) {
+        ssize_t sent = send(client.fd, &client.output[client.outputSent], client.output.size() - client.outputSent,
+                            MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+            break;
+        }
+        client.outputSent += static_cast<size_t>(sent);
+        bytesSentCount.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+    }
+
+    bool pending = client.outputSent < client.output.size();
+    if (!pending) {
+        client.output.clear(); // Keeps its capacity
+        client.outputSent = 0;
+    } else if (client.outputSent >= (1u << 20)) {
+        // A client that never quite catches up must not grow the buffer forever
+        client.output.erase(client.output.begin(), client.output.begin() + client.outputSent);
+        client.outputSent = 0;
+    }
+    watch(client);
+    return true;
+}
+
+// Wait for output room while output is pending, and stop reading requests
+// while the backlog is full. A hang-up still shows as EPOLLHUP or a failed send
+void ControlServer::watch(Client& client)
+{
+    uint32_t events = 0;
+    if (!BacklogFull(client.output, client.outputSent)) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (client.outputSent < client.output.size()) {
+        events |= EPOLLOUT;
+    }
+    if (events != client.events) {
+        epoll_event event = {};
+        event.events = events;
+        event.data.fd = client.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+        client.events = events;
+    }
+}
+
+void ControlServer::closeClient(int fd)
+{
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    clients.erase(fd);
+}
@@ -0,0 +1,142 @@
+#ifndef CONTROL_SERVER_H
+#define CONTROL_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "simulation.h"
+#include "snapshot_codec.h"
+#include "triple_buffer.h"
+
+// Local control and telemetry endpoint on a Unix-domain socket (Linux), for
+// SCADA stand-ins and test harnesses that query zone states and issue shed
+// commands without the GUI.
+//
+// Protocol: length-prefixed binary frames in host byte order (little-endian
+// on every supported target), fields packed without padding:
+//
+//   uint32 length   bytes that follow (message type + payload)
+//   uint8  type     ControlMessage
+//   ...    payload
+//
+// Client -> server
+//   QueryZones   (none)                        -> ZoneStates
+//   Command      uint8 SimCommandType, int32 zone -> CommandAck
+//   Subscribe    float loadDeadband            -> ZoneStates, then ZoneDeltas every tick
+//   SubscribePacked (none)                     -> PackedSnapshot every tick
+//   Unsubscribe  (none)                           (either subscription)
+// Server -> client
+//   ZoneStates   uint64 step, double time, uint32 count, count x uint8 state, count x float load
+//   CommandAck   uint8 accepted (0: the simulation's command queue was full)
+//   ZoneDeltas   uint64 step, double time, uint32 count, count x { uint32 zone, uint8 state, float load }
+//   PackedSnapshot  one snapshot_codec.h frame (decode with SnapshotDecoder)
+//   Error        message text; the connection is closed afterwards
+//
+// A delta lists the zones whose state changed or whose load moved more than
+// the subscriber's deadband since the last value sent to that subscriber;
+// ticks where nothing changed send nothing. The simulation thread only copies
+// a snapshot into a triple buffer and pokes an eventfd, so a slow client can
+// never block it: the epoll thread coalesces ticks for a client whose send
+// backlog is full, and the next delta catches up from what it last received.
+// Requests from such a client wait unread until its backlog drains, so one
+// that pipelines queries without reading the replies only fills its socket.
+//
+// The packed stream is encoded once per tick and shared by every packed
+// subscriber. A new subscriber, or one whose ticks were coalesced, first gets
+// a keyframe of the encoder's reference state and then the shared deltas.
+
+enum class ControlMessage : uint8_t {
+    QueryZones = 0x01,
+    Command = 0x02,
+    Subscribe = 0x03,
+    Unsubscribe = 0x04,
+    SubscribePacked = 0x05,
+
+    ZoneStates = 0x81,
+    CommandAck = 0x82,
+    ZoneDeltas = 0x83,
+    PackedSnapshot = 0x84,
+    Error = 0xFF
+};
+
+struct ControlServerStats {
+    uint64_t connections = 0;
+    uint64_t commands = 0;
+    uint64_t zoneUpdates = 0;  // Zone entries sent in ZoneStates and ZoneDeltas
+    uint64_t bytesSent = 0;
+    uint64_t coalescedTicks = 0; // Ticks skipped for a client with a full backlog
+};
+
+class ControlServer
+{
+public:
+    // `packed` sets the quantum and keyframe interval of the packed stream
+    explicit ControlServer(Simulation& simulation, SnapshotCodecParams packed = SnapshotCodecParams());
+    ~ControlServer();
+
+    // Listen on `socketPath` (an old socket file there is replaced) and start
+    // the server thread; false (after printing the reason) on failure
+    bool start(const std::string& socketPath);
+    void stop();
+
+    // Simulation thread: hand the current state to the server thread
+    void publish(const Simulation& simulation);
+
+    ControlServerStats stats() const;
+
+private:
+    struct Client {
+        int fd = -1;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        size_t outputSent = 0;
+        uint32_t events = 0; // Registered with epoll: EPOLLIN unless the backlog is full, EPOLLOUT while output is pending
+        bool subscribed = false;
+        bool packed = false;
+        bool packedSynced = false; // Holds the encoder's reference state, so deltas apply
+        float deadband = 0.0f;
+        std::vector<HouseState> sentState; // Last values this subscriber received
+        std::vector<float> sentLoad;
+    };
+
+    void run();
+    void acceptClients();
+    bool readClient(Client& client);
+    bool handleInput(Client& client);
+    bool handleFrame(Client& client, ControlMessage type, const uint8_t* payload, size_t size);
+    void sendUpdates();
+    void appendStates(Client& client, const SimSnapshot& snapshot);
+    void appendDeltas(Client& client, const SimSnapshot& snapshot);
+    void encodePacked();
+    void appendPacked(Client& client);
+    bool flush(Client& client);
+    void watch(Client& client);
+    void closeClient(int fd);
+
+    Simulation& simulation;
+    TripleBuffer<SimSnapshot> snapshots;
+    const SimSnapshot* latest; // Server thread: last acquired snapshot
+    uint64_t lastSentStep;
+
+    SnapshotEncoder encoder;
+    std::vector<uint8_t> packedFrame;    // This tick's PackedSnapshot message, shared by packed subscribers
+    std::vector<uint8_t> packedKeyframe; // Keyframe of the same state for subscribers out of sync
+    size_t packedEntries;
+    bool packedKeyframeReady;
+
+    std::string path;
+    int listenFd;
+    int epollFd;
+    int wakeFd;   // eventfd: a snapshot was published or stop() was called; open until destruction, so publish() never races a close
+    std::atomic<bool> running;
+    std::thread thread;
+    std::unordered_map<int, std::unique_ptr<Client>> clients;
+
+    std::atomic<uint64_t> connectionCount, commandCount, zoneUpdateCount, bytesSentCount, coalescedCount;
+};
+
+#endif // CONTROL_SERVER_H
@@ -0,0 +1,40 @@
+#include "event_log.h"
+#include "alloc_tracker.h"
+#include <cstdarg>
+#include <cstdio>
+
+EventLog::EventLog(size_t capacity)
+    : ring(capacity > 0 ? capacity : 1), head(0), count(0), currentVersion(0)
+{
+}
+
+void EventLog::add(const char* format, ...)
+{
+    ALLOC_SCOPE(AllocTag::Log);
+    std::lock_guard<std::mutex> lock(mutex);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(ring[head].text, sizeof(ring[head].text), format, args);
+    va_end(args);
+
+    head = (head + 1) % ring.size(); // Overwrite the oldest line once full
+    if (count < ring.size()) {
+        ++count;
+    }
+    ++currentVersion;
+}
+
+bool EventLog::copyIfChanged(std::vector<LogLine>& out, uint64_t& version) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (version == currentVersion) {
+        return false;
+    }
+    out.resize(count); // Reuses capacity after the first copy
+    size_t oldest = (head + ring.size() - count) % ring.size();
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ring[(oldest + i) % ring.size()];
+    }
+    version = currentVersion;
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// One formatted log message (long messages are truncated)
+struct LogLine {
+    char text[128];
+};
+
+// Bounded, thread-safe message log shared by the simulation and the UI.
+// Messages are formatted straight into a fixed ring of lines, so logging
+// never touches the heap. Events are rare compared to frames, so a mutex is
+// fine here; the UI only copies the lines out when the version number changes.
+class EventLog
+{
+public:
+    explicit EventLog(size_t capacity = 20);
+
+    // printf-style: add("%s: Power cut cooldown started.", name)
+    void add(const char* format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+    // Copy the current lines (oldest first) into `out` if they changed since
+    // `version`. Returns true (and updates `version`) when a copy was made.
+    bool copyIfChanged(std::vector<LogLine>& out, uint64_t& version) const;
+
+private:
+    mutable std::mutex mutex;
+    std::vector<LogLine> ring; // Allocated once, `capacity` lines
+    size_t head;               // Next line to write
+    size_t count;
+    uint64_t currentVersion;
+};
+
+#endif // EVENT_LOG_H
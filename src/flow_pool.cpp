@@ -0,0 +1,264 @@
+#include "flow_pool.h"
+#include "checkpoint.h"
+#include <cmath>
+
+static const uint32_t NONE = UINT32_MAX;
+
+glm::vec3 FlowPath::positionAt(double time) const
+{
+    double cycleTime = fmod(time + delayOffset, pathDuration);
+    float progress = static_cast<float>(cycleTime / pathDuration);
+    return startPos + (endPos - startPos) * progress;
+}
+
+FlowPool::FlowPool(size_t capacity, size_t zoneCount)
+    : startPos(capacity), endPos(capacity), duration(capacity), delay(capacity), target(capacity, -1),
+      generation(capacity, 0), livePosition(capacity, NONE), nextFree(capacity),
+      zoneNext(capacity, NONE), zonePrev(capacity, NONE), zoneHead(zoneCount, NONE),
+      freeHead(capacity > 0 ? 0 : NONE)
+{
+    live.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        nextFree[i] = i + 1 < capacity ? static_cast<uint32_t>(i + 1) : NONE;
+    }
+}
+
+FlowHandle FlowPool::spawn(const FlowPath& flow)
+{
+    FlowHandle handle;
+    if (freeHead == NONE) {
+        return handle;
+    }
+    uint32_t slot = freeHead;
+    freeHead = nextFree[slot];
+
+    startPos[slot] = flow.startPos;
+    endPos[slot] = flow.endPos;
+    duration[slot] = flow.pathDuration;
+    delay[slot] = flow.delayOffset;
+    target[slot] = flow.targetHouseIndex;
+    livePosition[slot] = static_cast<uint32_t>(live.size());
+    live.push_back(slot); // Within the reserved capacity
+
+    int zone = flow.targetHouseIndex;
+    if (zone >= 0 && static_cast<size_t>(zone) < zoneHead.size()) {
+        zonePrev[slot] = NONE;
+        zoneNext[slot] = zoneHead[zone];
+        if (zoneHead[zone] != NONE) {
+            zonePrev[zoneHead[zone]] = slot;
+        }
+        zoneHead[zone] = slot;
+    }
+
+    handle.index = slot;
+    handle.generation = generation[slot];
+    return handle;
+}
+
+bool FlowPool::alive(FlowHandle handle) const
+{
+    return handle.index < capacity() && livePosition[handle.index] != NONE &&
+           generation[handle.index] == handle.generation;
+}
+
+bool FlowPool::release(FlowHandle handle)
+{
+    if (!alive(handle)) {
+        return false;
+    }
+    releaseSlot(handle.index);
+    return true;
+}
+
+void FlowPool::releaseSlot(uint32_t slot)
+{
+    // Unlink from the zone list
+    int zone = target[slot];
+    if (zone >= 0 && static_cast<size_t>(zone) < zoneHead.size()) {
+        if (zonePrev[slot] != NONE) {
+            zoneNext[zonePrev[slot]] = zoneNext[slot];
+        } else {
+            zoneHead[zone] = zoneNext[slot];
+        }
+        if (zoneNext[slot] != NONE) {
+            zonePrev[zoneNext[slot]] = zonePrev[slot];
+        }
+    }
+
+    // Swap-remove from the dense list
+    uint32_t position = livePosition[slot];
+    uint32_t moved = live.back();
+    live[position] = moved;
+    livePosition[moved] = position;
+    live.pop_back();
+
+    livePosition[slot] = NONE;
+    ++generation[slot]; // Invalidates outstanding handles
+    nextFree[slot] = freeHead;
+    freeHead = slot;
+}
+
+size_t FlowPool::clearZone(int zone)
+{
+    if (zone < 0 || static_cast<size_t>(zone) >= zoneHead.size()) {
+        return 0;
+    }
+    size_t released = 0;
+    while (zoneHead[zone] != NONE) {
+        releaseSlot(zoneHead[zone]);
+        ++released;
+    }
+    return released;
+}
+
+void FlowPool::clear()
+{
+    while (!live.empty()) {
+        releaseSlot(live.back());
+    }
+}
+
+FlowPath FlowPool::get(uint32_t slot) const
+{
+    return { startPos[slot], endPos[slot], duration[slot], delay[slot], target[slot] };
+}
+
+void FlowPool::copyTo(std::vector<FlowPath>& out) const
+{
+    out.resize(live.size());
+    for (size_t i = 0; i < live.size(); ++i) {
+        out[i] = get(live[i]);
+    }
+}
+
+// --- Checkpoint ---
+
+void FlowPool::saveCheckpoint(CheckpointWriter& writer) const
+{
+    writer.add(CheckpointSection::FlowScalars, &freeHead, sizeof(freeHead));
+    writer.addArray(CheckpointSection::FlowStart, startPos);
+    writer.addArray(CheckpointSection::FlowEnd, endPos);
+    writer.addArray(CheckpointSection::FlowDuration, duration);
+    writer.addArray(CheckpointSection::FlowDelay, delay);
+    writer.addArray(CheckpointSection::FlowTarget, target);
+    writer.addArray(CheckpointSection::FlowGeneration, generation);
+    writer.addArray(CheckpointSection::FlowLivePosition, livePosition);
+    writer.addArray(CheckpointSection::FlowNextFree, nextFree);
+    writer.addArray(CheckpointSection::FlowZoneNext, zoneNext);
+    writer.addArray(CheckpointSection::FlowZonePrev, zonePrev);
+    writer.addArray(CheckpointSection::FlowLive, live);
+    writer.addArray(CheckpointSection::FlowZoneHead, zoneHead);
+}
+
+// The links of a checkpointed pool must form the structure spawn() and
+// releaseSlot() maintain, or the next step would index out of range: `live`
+// and livePosition inverse of each other, the free list holding exactly the
+// other slots, and each zone list exactly the live flows targeting the zone.
+// A list that repeats a slot never ends, so the walks are bounded by count.
+static bool ValidLinks(uint32_t freeHead, const std::vector<int32_t>& target, const std::vector<uint32_t>& livePosition,
+                       const std::vector<uint32_t>& nextFree, const std::vector<uint32_t>& zoneNext,
+                       const std::vector<uint32_t>& zonePrev, const std::vector<uint32_t>& live,
+                       const std::vector<uint32_t>& zoneHead)
+{
+    const size_t slots = livePosition.size();
+    for (size_t p = 0; p < live.size(); ++p) {
+        if (live[p] >= slots || livePosition[live[p]] != p) {
+            return false;
+        }
+    }
+    size_t zoned = 0; // Live flows that belong on a zone list
+    for (size_t slot = 0; slot < slots; ++slot) {
+        if (livePosition[slot] == NONE) {
+            continue;
+        }
+        if (livePosition[slot] >= live.size() || live[livePosition[slot]] != slot) {
+            return false;
+        }
+        if (target[slot] >= 0 && static_cast<size_t>(target[slot]) < zoneHead.size()) {
+            ++zoned;
+        }
+    }
+
+    size_t freeCount = 0;
+    for (uint32_t slot = freeHead; slot != NONE; slot = nextFree[slot]) {
+        if (slot >= slots || livePosition[slot] != NONE || freeCount == slots - live.size()) {
+            return false;
+        }
+        ++freeCount;
+    }
+    if (freeCount != slots - live.size()) {
+        return false;
+    }
+
+    size_t linked = 0;
+    for (size_t zone = 0; zone < zoneHead.size(); ++zone) {
+        uint32_t previous = NONE;
+        for (uint32_t slot = zoneHead[zone]; slot != NONE; slot = zoneNext[slot]) {
+            if (slot >= slots || livePosition[slot] == NONE || target[slot] != static_cast<int32_t>(zone) ||
+                zonePrev[slot] != previous || linked == zoned) {
+                return false;
+            }
+            previous = slot;
+            ++linked;
+        }
+    }
+    return linked == zoned;
+}
+
+bool FlowPool::canRestore(const CheckpointReader& reader) const
+{
+    const size_t slots = capacity();
+    size_t liveBytes = reader.sectionSize(CheckpointSection::FlowLive);
+    bool fits = reader.has(CheckpointSection::FlowScalars, sizeof(freeHead)) &&
+                reader.has(CheckpointSection::FlowStart, slots * sizeof(glm::vec3)) &&
+                reader.has(CheckpointSection::FlowEnd, slots * sizeof(glm::vec3)) &&
+                reader.has(CheckpointSection::FlowDuration, slots * sizeof(float)) &&
+                reader.has(CheckpointSection::FlowDelay, slots * sizeof(float)) &&
+                reader.has(CheckpointSection::FlowTarget, slots * sizeof(int32_t)) &&
+                reader.has(CheckpointSection::FlowGeneration, slots * sizeof(uint32_t)) &&
+                reader.has(CheckpointSection::FlowLivePosition, slots * sizeof(uint32_t)) &&
+                reader.has(CheckpointSection::FlowNextFree, slots * sizeof(uint32_t)) &&
+                reader.has(CheckpointSection::FlowZoneNext, slots * sizeof(uint32_t)) &&
+                reader.has(CheckpointSection::FlowZonePrev, slots * sizeof(uint32_t)) &&
+                reader.has(CheckpointSection::FlowZoneHead, zoneHead.size() * sizeof(uint32_t)) &&
+                liveBytes % sizeof(uint32_t) == 0 && liveBytes <= slots * sizeof(uint32_t);
+    if (!fits) {
+        return false;
+    }
+
+    uint32_t savedFreeHead = NONE;
+    std::vector<int32_t> savedTarget(slots);
+    std::vector<uint32_t> savedLivePosition(slots), savedNextFree(slots), savedZoneNext(slots), savedZonePrev(slots);
+    std::vector<uint32_t> savedLive(liveBytes / sizeof(uint32_t)), savedZoneHead(zoneHead.size());
+    reader.read(CheckpointSection::FlowScalars, &savedFreeHead, sizeof(savedFreeHead));
+    reader.readArray(CheckpointSection::FlowTarget, savedTarget);
+    reader.readArray(CheckpointSection::FlowLivePosition, savedLivePosition);
+    reader.readArray(CheckpointSection::FlowNextFree, savedNextFree);
+    reader.readArray(CheckpointSection::FlowZoneNext, savedZoneNext);
+    reader.readArray(CheckpointSection::FlowZonePrev, savedZonePrev);
+    reader.readArray(CheckpointSection::FlowLive, savedLive);
+    reader.readArray(CheckpointSection::FlowZoneHead, savedZoneHead);
+    return ValidLinks(savedFreeHead, savedTarget, savedLivePosition, savedNextFree, savedZoneNext, savedZonePrev,
+                      savedLive, savedZoneHead);
+}
+
+void FlowPool::restoreCheckpoint(const CheckpointReader& reader)
+{
+    if (!canRestore(reader)) {
+        return;
+    }
+    live.resize(reader.sectionSize(CheckpointSection::FlowLive) / sizeof(uint32_t)); // Within the reserved capacity
+    reader.read(CheckpointSection::FlowScalars, &freeHead, sizeof(freeHead));
+    reader.readArray(CheckpointSection::FlowStart, startPos);
+    reader.readArray(CheckpointSection::FlowEnd, endPos);
+    reader.readArray(CheckpointSection::FlowDuration, duration);
+    reader.readArray(CheckpointSection::FlowDelay, delay);
+    reader.readArray(CheckpointSection::FlowTarget, target);
+    reader.readArray(CheckpointSection::FlowGeneration, generation);
+    reader.readArray(CheckpointSection::FlowLivePosition, livePosition);
+    reader.readArray(CheckpointSection::FlowNextFree, nextFree);
+    reader.readArray(CheckpointSection::FlowZoneNext, zoneNext);
+    reader.readArray(CheckpointSection::FlowZonePrev, zonePrev);
+    reader.readArray(CheckpointSection::FlowLive, live);
+    reader.readArray(CheckpointSection::FlowZoneHead, zoneHead);
+}
@@ -0,0 +1,85 @@
+#ifndef FLOW_POOL_H
+#define FLOW_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// An animated flow of power along a straight path (generator -> transmitter or
+// transmitter -> house). Position is a pure function of simulation time.
+struct FlowPath {
+    glm::vec3 startPos;
+    glm::vec3 endPos;
+    float pathDuration;
+    float delayOffset;
+    int targetHouseIndex; // -1 if the path does not end at a house
+
+    glm::vec3 positionAt(double time) const;
+};
+
+// Refers to one pooled flow; stale once the flow is released (the slot's
+// generation moves on), so holders can never touch a reused slot.
+struct FlowHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Fixed-capacity pool of flows, stored SoA. Everything is allocated up front:
+// spawn/release are O(1) through a free list, live flows are kept dense for
+// iteration, and each zone heads an intrusive list of the flows targeting it
+// so clearing a zone only touches that zone's flows.
+class FlowPool
+{
+public:
+    FlowPool(size_t capacity, size_t zoneCount);
+
+    // Returns an invalid handle (alive() == false) when the pool is full
+    FlowHandle spawn(const FlowPath& flow);
+    bool release(FlowHandle handle);
+    bool alive(FlowHandle handle) const;
+
+    // Release every flow targeting `zone`; returns how many were released
+    size_t clearZone(int zone);
+    void clear();
+
+    size_t size() const { return live.size(); }
+    size_t capacity() const { return generation.size(); }
+
+    FlowPath get(uint32_t slot) const;
+
+    // Live flows (in pool order) into `out`, reusing its capacity
+    void copyTo(std::vector<FlowPath>& out) const;
+
+    // Checkpoint every array as is (checkpoint.h). A checkpoint only fits a
+    // pool with the same capacity and zone count whose free, live and zone
+    // lists are consistent; restoreCheckpoint() does nothing unless
+    // canRestore() holds.
+    void saveCheckpoint(CheckpointWriter& writer) const;
+    bool canRestore(const CheckpointReader& reader) const;
+    void restoreCheckpoint(const CheckpointReader& reader);
+
+private:
+    void releaseSlot(uint32_t slot);
+
+    // Per slot (SoA)
+    std::vector<glm::vec3> startPos;
+    std::vector<glm::vec3> endPos;
+    std::vector<float> duration;
+    std::vector<float> delay;
+    std::vector<int32_t> target;
+    std::vector<uint32_t> generation;
+    std::vector<uint32_t> livePosition; // Index into `live`, NONE when free
+    std::vector<uint32_t> nextFree;
+    std::vector<uint32_t> zoneNext;     // Links of the per-zone lists
+    std::vector<uint32_t> zonePrev;
+
+    std::vector<uint32_t> live;     // Dense list of live slots
+    std::vector<uint32_t> zoneHead; // First slot targeting each zone
+    uint32_t freeHead;
+};
+
+#endif // FLOW_POOL_H
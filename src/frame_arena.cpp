@@ -0,0 +1,67 @@
+#include "frame_arena.h"
+#include <algorithm>
+
+// Plain operator new (not the aligned overloads) so the allocation tracker sees
+// every upstream allocation; it already returns max_align_t-aligned memory.
+static char* allocateBlock(size_t size)
+{
+    return static_cast<char*>(::operator new(size));
+}
+
+FrameArena::FrameArena(size_t initialCapacity)
+    : block(allocateBlock(std::max<size_t>(initialCapacity, 64))), blockSize(std::max<size_t>(initialCapacity, 64)),
+      offset(0), overflowList(nullptr), overflowBytes(0), peak(0), overflows(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    while (overflowList) {
+        Overflow* next = overflowList->next;
+        ::operator delete(overflowList);
+        overflowList = next;
+    }
+    ::operator delete(block);
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+    // Align the address, not the offset: alignments above the block's are allowed
+    uintptr_t base = reinterpret_cast<uintptr_t>(block);
+    size_t aligned = ((base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+    if (aligned + bytes <= blockSize) {
+        offset = aligned + bytes;
+        peak = std::max(peak, used());
+        return block + aligned;
+    }
+
+    // Block exhausted: chain an upstream chunk (list node, then the aligned payload)
+    char* chunk = allocateBlock(sizeof(Overflow) + alignment - 1 + bytes);
+    Overflow* node = reinterpret_cast<Overflow*>(chunk);
+    node->next = overflowList;
+    overflowList = node;
+    overflowBytes += bytes;
+    ++overflows;
+    peak = std::max(peak, used());
+    uintptr_t payload = reinterpret_cast<uintptr_t>(chunk) + sizeof(Overflow);
+    return reinterpret_cast<void*>((payload + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+}
+
+void FrameArena::reset()
+{
+    if (overflowList) {
+        while (overflowList) {
+            Overflow* next = overflowList->next;
+            ::operator delete(overflowList);
+            overflowList = next;
+        }
+        overflowBytes = 0;
+
+        // Next frame fits in one block: grow to the high-water mark plus headroom
+        size_t newSize = std::max(blockSize * 2, peak + peak / 2);
+        ::operator delete(block);
+        block = allocateBlock(newSize);
+        blockSize = newSize;
+    }
+    offset = 0;
+}
@@ -0,0 +1,52 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Bump allocator for scratch data that lives for one simulation step or one
+// frame. Allocation is a pointer bump, deallocation is a no-op and reset()
+// releases everything at once. Being a std::pmr::memory_resource, existing
+// vector code only needs `std::pmr::vector<T> v(&arena)`.
+//
+// When a frame needs more than the current block, the extra memory comes
+// from the upstream allocator; the next reset() replaces the block with one
+// large enough for the high-water mark, so steady-state frames never touch
+// the heap. Not thread-safe: one arena per thread.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    explicit FrameArena(size_t initialCapacity = 64 * 1024);
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Free everything allocated since the last reset (grows the block if it overflowed)
+    void reset();
+
+    size_t used() const { return offset + overflowBytes; }
+    size_t capacity() const { return blockSize; }
+    size_t highWater() const { return peak; }
+    uint64_t overflowCount() const { return overflows; } // Upstream allocations so far
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    struct Overflow {
+        Overflow* next;
+    };
+
+    char* block;
+    size_t blockSize;
+    size_t offset;
+    Overflow* overflowList; // Upstream chunks handed out since the last reset
+    size_t overflowBytes;
+    size_t peak;
+    uint64_t overflows;
+};
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,200 @@
+#include "frame_capture.h"
+#include "alloc_tracker.h"
+#include "image_encoders.h"
+#include "profiler.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+FrameCapture::FrameCapture(int latencyFrames, unsigned encoderThreads)
+    : latency(latencyFrames), pool(encoderThreads), format(CaptureFormat::QOI), w(0), h(0),
+      nextFrame(0), renderThreadSeconds(0.0), stream(nullptr), nextFrameToWrite(0)
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+bool FrameCapture::start(const std::string& outputPath, CaptureFormat outputFormat, int width, int height, int fps)
+{
+    stop();
+
+    path = outputPath;
+    format = outputFormat;
+    w = width;
+    h = height;
+    nextFrame = 0;
+    nextFrameToWrite = 0;
+    renderThreadSeconds = 0.0;
+    counters = CaptureStats();
+
+    std::error_code error;
+    if (format == CaptureFormat::Y4M) {
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent, error);
+        }
+        stream = fopen(path.c_str(), "wb");
+        if (!stream) {
+            std::cerr << "ERROR::CAPTURE::OPEN_FAILED " << path << "\n";
+            return false;
+        }
+        std::string header = Y4MHeader(w, h, fps);
+        fwrite(header.data(), 1, header.size(), stream);
+    } else {
+        std::filesystem::create_directories(path, error);
+        if (error) {
+            std::cerr << "ERROR::CAPTURE::OPEN_FAILED " << path << "\n";
+            return false;
+        }
+    }
+
+    readback.reset(new PixelReadback(w, h, latency + 1));
+    return true;
+}
+
+void FrameCapture::captureFrame()
+{
+    if (!readback) {
+        return;
+    }
+    auto begin = std::chrono::steady_clock::now();
+
+    // Hand off everything the GPU has finished, then block only if the ring is full
+    collect(false);
+    if (readback->full()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counters.readbackStalls;
+    }
+    while (readback->full()) {
+        collect(true);
+    }
+    readback->capture(nextFrame++);
+
+    renderThreadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::lock_guard<std::mutex> lock(mutex);
+    ++counters.framesCaptured;
+    counters.renderThreadMs = 1000.0 * renderThreadSeconds / counters.framesCaptured;
+}
+
+void FrameCapture::collect(bool wait)
+{
+    ALLOC_SCOPE(AllocTag::Capture);
+    for (;;) {
+        std::vector<uint8_t> pixels = acquireBuffer();
+        uint64_t frame;
+        ReadbackStatus status = readback->collect(pixels, frame, wait);
+        if (status == ReadbackStatus::NotReady) {
+            releaseBuffer(std::move(pixels));
+            return;
+        }
+
+        // Bound the queue so a slow disk throttles capture instead of eating memory
+        pool.waitBelow(pool.threadCount() * 4);
+        if (status == ReadbackStatus::Lost) {
+            // Still takes its turn, or every later Y4M frame would wait for it forever
+            releaseBuffer(std::move(pixels));
+            pool.submit([this, frame]() { skip(frame); });
+        } else {
+            std::shared_ptr<std::vector<uint8_t>> owned = std::make_shared<std::vector<uint8_t>>(std::move(pixels));
+            pool.submit([this, frame, owned]() { encode(frame, *owned); });
+        }
+
+        if (wait) {
+            return; // Caller only needed one slot freed
+        }
+    }
+}
+
+void FrameCapture::encode(uint64_t frame, std::vector<uint8_t>& pixels)
+{
+    PROFILE_SCOPE("Encode frame");
+    ALLOC_SCOPE(AllocTag::Capture);
+    thread_local std::vector<uint8_t> encoded; // Keeps its capacity across frames
+    encoded.clear();
+
+    switch (format) {
+        case CaptureFormat::QOI: EncodeQOI(pixels.data(), w, h, encoded); break;
+        case CaptureFormat::PNG: EncodePNG(pixels.data(), w, h, encoded); break;
+        case CaptureFormat::Y4M: EncodeY4MFrame(pixels.data(), w, h, encoded); break;
+    }
+    releaseBuffer(std::move(pixels));
+
+    if (format == CaptureFormat::Y4M) {
+        std::unique_lock<std::mutex> lock(mutex);
+        writeTurn.wait(lock, [&] { return nextFrameToWrite == frame; });
+        fwrite(encoded.data(), 1, encoded.size(), stream);
+        ++nextFrameToWrite;
+        ++counters.framesWritten;
+        lock.unlock();
+        writeTurn.notify_all();
+        return;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%06llu.%s", (unsigned long long)frame,
+             format == CaptureFormat::QOI ? "qoi" : "png");
+    std::string file = (std::filesystem::path(path) / name).string();
+    FILE* out = fopen(file.c_str(), "wb");
+    if (out) {
+        fwrite(encoded.data(), 1, encoded.size(), out);
+        fclose(out);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++counters.framesWritten;
+}
+
+void FrameCapture::skip(uint64_t frame)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    ++counters.framesLost;
+    if (format == CaptureFormat::Y4M) {
+        writeTurn.wait(lock, [&] { return nextFrameToWrite == frame; });
+        ++nextFrameToWrite; // The stream just has one frame fewer
+        lock.unlock();
+        writeTurn.notify_all();
+    }
+}
+
+void FrameCapture::stop()
+{
+    if (!readback) {
+        return;
+    }
+    while (!readback->empty()) {
+        collect(true);
+    }
+    pool.waitIdle();
+    readback.reset();
+
+    if (stream) {
+        fclose(stream);
+        stream = nullptr;
+    }
+}
+
+CaptureStats FrameCapture::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+std::vector<uint8_t> FrameCapture::acquireBuffer()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBuffers.empty()) {
+        return std::vector<uint8_t>();
+    }
+    std::vector<uint8_t> buffer = std::move(freeBuffers.back());
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+void FrameCapture::releaseBuffer(std::vector<uint8_t>&& buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.push_back(std::move(buffer));
+}
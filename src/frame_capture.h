@@ -0,0 +1,80 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "render_target.h"
+#include "worker_pool.h"
+
+enum class CaptureFormat {
+    QOI, // Image sequence, fast lossless
+    PNG, // Image sequence, uncompressed deflate
+    Y4M  // Single raw YUV4MPEG2 video stream
+};
+
+struct CaptureStats {
+    uint64_t framesCaptured = 0;
+    uint64_t framesWritten = 0;
+    uint64_t framesLost = 0;       // Readbacks that failed (sync or map error); not written
+    uint64_t readbackStalls = 0;   // Times the PBO ring was full and we had to wait
+    double renderThreadMs = 0.0;   // Average time captureFrame() took on the render thread
+};
+
+// Records rendered frames without stalling the pipeline.
+// glReadPixels goes into a ring of pixel-pack buffers that is mapped a few
+// frames later; the pixels are then handed to a worker pool for encoding and
+// disk I/O. All methods except the stats accessors need the GL context current.
+class FrameCapture
+{
+public:
+    explicit FrameCapture(int latencyFrames = 3, unsigned encoderThreads = 0);
+    ~FrameCapture();
+
+    // `path` is a directory for image sequences (frame_000000.qoi, ...) or a
+    // file for Y4M. Returns false if the output cannot be created.
+    bool start(const std::string& path, CaptureFormat format, int width, int height, int fps);
+
+    // Capture the framebuffer currently bound for reading. Call once per frame.
+    void captureFrame();
+
+    // Drain in-flight readbacks and encoders, then close the output
+    void stop();
+
+    bool recording() const { return readback != nullptr; }
+    int width() const { return w; }
+    int height() const { return h; }
+    CaptureStats stats() const;
+
+private:
+    void collect(bool wait);
+    void encode(uint64_t frame, std::vector<uint8_t>& pixels);
+    void skip(uint64_t frame); // Account for a lost frame in the write order
+    std::vector<uint8_t> acquireBuffer();
+    void releaseBuffer(std::vector<uint8_t>&& buffer);
+
+    int latency;
+    WorkerPool pool;
+    std::unique_ptr<PixelReadback> readback;
+
+    CaptureFormat format;
+    std::string path;
+    int w, h;
+    uint64_t nextFrame;
+    double renderThreadSeconds;
+
+    // Y4M frames must hit the file in order even though workers finish out of order
+    FILE* stream;
+    uint64_t nextFrameToWrite;
+    std::condition_variable writeTurn;
+
+    mutable std::mutex mutex; // Guards the buffer pool, stream ordering and stats
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    CaptureStats counters;
+};
+
+#endif // FRAME_CAPTURE_H
@@ -0,0 +1,88 @@
+#include "frame_scheduler.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+FrameScheduler::FrameScheduler(GLFWwindow* window)
+    : window(window), nextFrameTime(0.0), pendingRedraws(0), appliedVsync(false)
+{
+    apply();
+}
+
+void FrameScheduler::apply()
+{
+    glfwSwapInterval(pacing.vsync ? 1 : 0);
+    appliedVsync = pacing.vsync;
+    nextFrameTime = glfwGetTime();
+}
+
+void FrameScheduler::requestRedraw(int frames)
+{
+    int pending = pendingRedraws.load();
+    while (pending < frames && !pendingRedraws.compare_exchange_weak(pending, frames)) {
+    }
+    glfwPostEmptyEvent(); // Wake glfwWaitEventsTimeout if another thread asked
+}
+
+// Sleep until `deadline` (glfwGetTime seconds). The OS sleep is coarse, so the
+// last millisecond is spent yielding instead.
+static void sleepUntil(double deadline)
+{
+    double remaining = deadline - glfwGetTime();
+    if (remaining > 0.002) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining - 0.001));
+    }
+    while (glfwGetTime() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void FrameScheduler::waitForNextFrame()
+{
+    if (pacing.vsync != appliedVsync) {
+        apply();
+    }
+
+    double now = glfwGetTime();
+
+    // Minimized windows draw nothing useful: block until something happens
+    if (glfwGetWindowAttrib(window, GLFW_ICONIFIED)) {
+        glfwWaitEventsTimeout(0.25);
+        nextFrameTime = glfwGetTime();
+        return;
+    }
+
+    if (pacing.adaptive) {
+        double period = 1.0 / std::max(pacing.idleFps, 1);
+        if (pendingRedraws.load() > 0) {
+            pendingRedraws.fetch_sub(1);
+            nextFrameTime = now; // The idle period counts from the last redraw
+            glfwPollEvents();
+            return;
+        }
+
+        // Block until input or a redraw request arrives, or the next
+        // simulation-driven redraw is due
+        nextFrameTime = std::max(nextFrameTime + period, now);
+        glfwWaitEventsTimeout(std::max(nextFrameTime - now, 0.0));
+
+        // Woken early by an event: give ImGui one extra frame to react to it,
+        // and count the next idle period from now rather than the old deadline
+        double woke = glfwGetTime();
+        if (woke < nextFrameTime) {
+            requestRedraw(1);
+            nextFrameTime = woke;
+        }
+        return;
+    }
+
+    if (pacing.targetFps > 0) {
+        // Fixed deadlines; if we fell behind, resync instead of bursting to catch up
+        double period = 1.0 / pacing.targetFps;
+        nextFrameTime = std::max(nextFrameTime + period, now);
+        sleepUntil(nextFrameTime);
+    }
+    glfwPollEvents();
+}
@@ -0,0 +1,44 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <atomic>
+
+struct GLFWwindow;
+
+// Frame pacing settings, editable from the UI
+struct FramePacing {
+    bool vsync = true;     // glfwSwapInterval(1)
+    int targetFps = 60;    // Frame cap when not adaptive, 0 = uncapped
+    bool adaptive = false; // Sleep in glfwWaitEventsTimeout between redraws
+    int idleFps = 30;      // Simulation-driven redraw rate in adaptive mode
+};
+
+// Decides when the next frame is produced.
+// Replaces the bare glfwPollEvents() at the end of the main loop: depending on
+// the settings it either polls, sleeps until the frame cap deadline, or blocks
+// on window events until input arrives or the next simulation redraw is due.
+class FrameScheduler
+{
+public:
+    explicit FrameScheduler(GLFWwindow* window);
+
+    // Push the current settings to GLFW (swap interval). Call after editing `pacing`.
+    void apply();
+
+    // Ask for an immediate redraw (state change); `frames` lets ImGui settle.
+    // Safe to call from any thread: wakes a waiting waitForNextFrame().
+    void requestRedraw(int frames = 1);
+
+    // Process events and wait until the next frame should start
+    void waitForNextFrame();
+
+    FramePacing pacing;
+
+private:
+    GLFWwindow* window;
+    double nextFrameTime;  // Deadline for the capped / adaptive modes
+    std::atomic<int> pendingRedraws;
+    bool appliedVsync;
+};
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,34 @@
+#include "gl_features.h"
+#include <cstring>
+
+static GlFeatures features;
+
+static bool hasExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const GlFeatures& LoadGlFeatures(GLADloadproc load)
+{
+    features = GlFeatures();
+
+    bool core43 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+    if (core43 || (hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance"))) {
+        features.multiDrawElementsIndirect = (PFNPGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+        features.multiDrawIndirect = features.multiDrawElementsIndirect != nullptr;
+    }
+    return features;
+}
+
+const GlFeatures& GlSupport()
+{
+    return features;
+}
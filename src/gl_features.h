@@ -0,0 +1,26 @@
+#ifndef GL_FEATURES_H
+#define GL_FEATURES_H
+
+#include <glad/glad.h>
+
+// Optional GL entry points above the 3.3 core that glad loads.
+// LoadGlFeatures() runs right after gladLoadGLLoader() with the same loader;
+// renderers check GlSupport() and fall back to 3.3 paths when a feature is missing.
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+typedef void (APIENTRYP PFNPGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+struct GlFeatures {
+    // glMultiDrawElementsIndirect with a working baseInstance (GL 4.3, or ARB_multi_draw_indirect + ARB_base_instance)
+    bool multiDrawIndirect = false;
+    PFNPGLMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect = nullptr;
+};
+
+// Query the current context; returns GlSupport()
+const GlFeatures& LoadGlFeatures(GLADloadproc load);
+const GlFeatures& GlSupport();
+
+#endif // GL_FEATURES_H
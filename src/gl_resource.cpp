@@ -0,0 +1,62 @@
+#include "gl_resource.h"
+#include <mutex>
+#include <vector>
+
+struct PendingDelete {
+    GlObjectType type;
+    GLuint name;
+};
+
+static std::mutex queueMutex;
+static std::vector<PendingDelete> queue;
+static std::vector<PendingDelete> draining; // Swapped with `queue`; both keep their capacity
+
+GLuint GlCreateObject(GlObjectType type)
+{
+    GLuint name = 0;
+    switch (type) {
+        case GlObjectType::Buffer: glGenBuffers(1, &name); break;
+        case GlObjectType::VertexArray: glGenVertexArrays(1, &name); break;
+        case GlObjectType::Program: name = glCreateProgram(); break;
+        case GlObjectType::Texture: glGenTextures(1, &name); break;
+        case GlObjectType::Framebuffer: glGenFramebuffers(1, &name); break;
+        case GlObjectType::Renderbuffer: glGenRenderbuffers(1, &name); break;
+        case GlObjectType::Query: glGenQueries(1, &name); break;
+    }
+    return name;
+}
+
+void GlDeletionQueue::defer(GlObjectType type, GLuint name)
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    queue.push_back({type, name});
+}
+
+size_t GlDeletionQueue::pending()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return queue.size();
+}
+
+void GlDeletionQueue::drain()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (queue.empty()) {
+            return;
+        }
+        draining.swap(queue);
+    }
+    for (const PendingDelete& item : draining) {
+        switch (item.type) {
+            case GlObjectType::Buffer: glDeleteBuffers(1, &item.name); break;
+            case GlObjectType::VertexArray: glDeleteVertexArrays(1, &item.name); break;
+            case GlObjectType::Program: glDeleteProgram(item.name); break;
+            case GlObjectType::Texture: glDeleteTextures(1, &item.name); break;
+            case GlObjectType::Framebuffer: glDeleteFramebuffers(1, &item.name); break;
+            case GlObjectType::Renderbuffer: glDeleteRenderbuffers(1, &item.name); break;
+            case GlObjectType::Query: glDeleteQueries(1, &item.name); break;
+        }
+    }
+    draining.clear();
+}
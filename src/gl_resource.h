@@ -0,0 +1,93 @@
+#ifndef GL_RESOURCE_H
+#define GL_RESOURCE_H
+
+#include <cstddef>
+#include <glad/glad.h>
+
+// Move-only owners for GL object names.
+// Copying is disabled, so a GL object can never be deleted twice. Destruction
+// does not call glDelete* directly: the name goes to GlDeletionQueue and is
+// deleted when the owner of the context drains the queue at a frame boundary.
+// That keeps deletes out of the middle of a frame, lets objects be released
+// from any thread, and makes destruction after the context is gone harmless.
+
+enum class GlObjectType {
+    Buffer,
+    VertexArray,
+    Program,
+    Texture,
+    Framebuffer,
+    Renderbuffer,
+    Query
+};
+
+class GlDeletionQueue
+{
+public:
+    // Thread-safe
+    static void defer(GlObjectType type, GLuint name);
+
+    // Delete everything queued so far; call with the context current (once per frame)
+    static void drain();
+
+    static size_t pending();
+};
+
+template <GlObjectType Type>
+class GlHandle
+{
+public:
+    GlHandle() : name(0) {}
+    explicit GlHandle(GLuint name) : name(name) {} // Adopt an existing name
+    ~GlHandle() { reset(); }
+
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+
+    GlHandle(GlHandle&& other) noexcept : name(other.name) { other.name = 0; }
+    GlHandle& operator=(GlHandle&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            name = other.name;
+            other.name = 0;
+        }
+        return *this;
+    }
+
+    // glGen*/glCreateProgram a fresh object
+    static GlHandle create();
+
+    GLuint get() const { return name; }
+    explicit operator bool() const { return name != 0; }
+
+    // Queue the object for deletion and become empty
+    void reset()
+    {
+        if (name != 0) {
+            GlDeletionQueue::defer(Type, name);
+            name = 0;
+        }
+    }
+
+private:
+    GLuint name;
+};
+
+GLuint GlCreateObject(GlObjectType type);
+
+template <GlObjectType Type>
+GlHandle<Type> GlHandle<Type>::create()
+{
+    return GlHandle<Type>(GlCreateObject(Type));
+}
+
+using GlBuffer = GlHandle<GlObjectType::Buffer>;
+using GlVertexArray = GlHandle<GlObjectType::VertexArray>;
+using GlProgram = GlHandle<GlObjectType::Program>;
+using GlTexture = GlHandle<GlObjectType::Texture>;
+using GlFramebuffer = GlHandle<GlObjectType::Framebuffer>;
+using GlRenderbuffer = GlHandle<GlObjectType::Renderbuffer>;
+using GlQuery = GlHandle<GlObjectType::Query>;
+
+#endif // GL_RESOURCE_H
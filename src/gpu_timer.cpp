@@ -0,0 +1,62 @@
+#include "gpu_timer.h"
+#include "profiler.h"
+
+GpuTimerPool::GpuTimerPool(int framesInFlight, int zonesPerFrame)
+    : slots(framesInFlight), current(0), open(false), skipped(0)
+{
+    for (FrameSlot& slot : slots) {
+        for (int i = 0; i < zonesPerFrame; ++i) {
+            slot.queries.push_back(GlQuery::create());
+        }
+        slot.zones.resize(zonesPerFrame);
+        slot.used = 0;
+    }
+}
+
+void GpuTimerPool::beginFrame()
+{
+    current = (current + 1) % static_cast<int>(slots.size());
+    FrameSlot& slot = slots[current];
+
+    // The slot was filled framesInFlight frames ago; its results are normally ready
+    if (slot.used > 0) {
+        GLint available = 0;
+        glGetQueryObjectiv(slot.queries[slot.used - 1].get(), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            latest.clear();
+            for (int i = 0; i < slot.used; ++i) {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(slot.queries[i].get(), GL_QUERY_RESULT, &elapsed);
+                latest.push_back({slot.zones[i].name, elapsed / 1.0e6});
+                Profiler::recordGpuZone(slot.zones[i].name, slot.zones[i].cpuStart, elapsed);
+            }
+        }
+    }
+    slot.used = 0;
+}
+
+void GpuTimerPool::begin(const char* name)
+{
+    FrameSlot& slot = slots[current];
+    if (open || slot.used == static_cast<int>(slot.queries.size())) {
+        ++skipped; // Nested or out of queries: zone is skipped
+        return;
+    }
+    slot.zones[slot.used] = {name, Profiler::now()};
+    glBeginQuery(GL_TIME_ELAPSED, slot.queries[slot.used].get());
+    open = true;
+}
+
+void GpuTimerPool::end()
+{
+    if (skipped > 0) {
+        --skipped;
+        return;
+    }
+    if (!open) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    ++slots[current].used;
+    open = false;
+}
@@ -0,0 +1,61 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "gl_resource.h"
+
+// Pool of GL_TIME_ELAPSED queries for timing GPU passes.
+// Queries of frame N are read back when their slot comes around again
+// (framesInFlight frames later), so reading results never stalls the GPU.
+// TIME_ELAPSED queries cannot nest: GPU zones must be sequential.
+class GpuTimerPool
+{
+public:
+    struct Result {
+        const char* name;
+        double milliseconds;
+    };
+
+    explicit GpuTimerPool(int framesInFlight = 4, int zonesPerFrame = 16);
+
+    // Start of a frame: harvest the slot's old queries, then reuse it
+    void beginFrame();
+
+    void begin(const char* name);
+    void end();
+
+    // Zones of the most recently completed frame
+    const std::vector<Result>& results() const { return latest; }
+
+private:
+    struct Zone {
+        const char* name;
+        uint64_t cpuStart; // Profiler::now() when the query was issued
+    };
+    struct FrameSlot {
+        std::vector<GlQuery> queries;
+        std::vector<Zone> zones;
+        int used;
+    };
+
+    std::vector<FrameSlot> slots;
+    int current;
+    bool open;
+    int skipped; // begin() calls that did not get a query, matched by end()
+    std::vector<Result> latest;
+};
+
+// Scoped GPU zone; a no-op when `pool` is null
+class GpuScope
+{
+public:
+    GpuScope(GpuTimerPool* pool, const char* name) : pool(pool) { if (pool) pool->begin(name); }
+    ~GpuScope() { if (pool) pool->end(); }
+
+private:
+    GpuTimerPool* pool;
+};
+
+#endif // GPU_TIMER_H
@@ -0,0 +1,155 @@
+#include "headless_context.h"
+#include <iostream>
+#include <glad/glad.h>
+#include "gl_features.h"
+#include "gl_resource.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifdef PGLMS_WITH_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+HeadlessContext::HeadlessContext()
+    : active(AUTO), display(nullptr), context(nullptr), osmesaPixel()
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+bool HeadlessContext::create(Backend backend)
+{
+    bool ok = false;
+    if (backend == AUTO || backend == EGL) {
+        ok = createEGL();
+    }
+    if (!ok && (backend == AUTO || backend == OSMESA)) {
+        ok = createOSMesa();
+    }
+    if (!ok) {
+        std::cerr << "ERROR::HEADLESS::NO_CONTEXT\n";
+        return false;
+    }
+
+    info += " | ";
+    info += reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    info += " | GL ";
+    info += reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    return true;
+}
+
+bool HeadlessContext::createEGL()
+{
+    // Prefer the surfaceless platform: needs no X11/Wayland/GBM device at all
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        return false;
+    }
+
+    EGLint major, minor;
+    if (!eglInitialize(eglDisplay, &major, &minor)) {
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        eglTerminate(eglDisplay);
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    // No config and no surface: everything is drawn into FBOs
+    EGLContext eglContext = eglCreateContext(eglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+    if (eglContext == EGL_NO_CONTEXT) {
+        eglTerminate(eglDisplay);
+        return false;
+    }
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+        eglDestroyContext(eglDisplay, eglContext);
+        eglTerminate(eglDisplay);
+        return false;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, eglContext);
+        eglTerminate(eglDisplay);
+        return false;
+    }
+    LoadGlFeatures((GLADloadproc)eglGetProcAddress);
+
+    display = eglDisplay;
+    context = eglContext;
+    active = EGL;
+    info = "EGL " + std::to_string(major) + "." + std::to_string(minor) + " surfaceless";
+    return true;
+}
+
+bool HeadlessContext::createOSMesa()
+{
+#ifdef PGLMS_WITH_OSMESA
+    const int attribs[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+    OSMesaContext osmesa = OSMesaCreateContextAttribs(attribs, nullptr);
+    if (!osmesa) {
+        return false;
+    }
+    if (!OSMesaMakeCurrent(osmesa, osmesaPixel, GL_UNSIGNED_BYTE, 1, 1)) {
+        OSMesaDestroyContext(osmesa);
+        return false;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)OSMesaGetProcAddress)) {
+        OSMesaDestroyContext(osmesa);
+        return false;
+    }
+    LoadGlFeatures((GLADloadproc)OSMesaGetProcAddress);
+
+    context = osmesa;
+    active = OSMESA;
+    info = "OSMesa";
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HeadlessContext::destroy()
+{
+    // Objects owned by GL wrappers that died before the context
+    if (active != AUTO) {
+        GlDeletionQueue::drain();
+    }
+    if (active == EGL) {
+        EGLDisplay eglDisplay = static_cast<EGLDisplay>(display);
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, static_cast<EGLContext>(context));
+        eglTerminate(eglDisplay);
+    }
+#ifdef PGLMS_WITH_OSMESA
+    if (active == OSMESA) {
+        OSMesaDestroyContext(static_cast<OSMesaContext>(context));
+    }
+#endif
+    active = AUTO;
+    display = nullptr;
+    context = nullptr;
+}
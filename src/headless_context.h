@@ -0,0 +1,41 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <string>
+
+// Windowless OpenGL 3.3 core context, the headless alternative to glfwCreateWindow.
+// Tries surfaceless EGL first (Mesa llvmpipe works without any display), then
+// OSMesa when built with PGLMS_WITH_OSMESA. There is no default framebuffer:
+// render into a RenderTarget.
+class HeadlessContext
+{
+public:
+    enum Backend {
+        AUTO,
+        EGL,
+        OSMESA
+    };
+
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // Create the context, make it current and load GL entry points through glad
+    bool create(Backend backend = AUTO);
+
+    const std::string& description() const { return info; }
+
+private:
+    bool createEGL();
+    bool createOSMesa();
+    void destroy();
+
+    Backend active;
+    std::string info;
+
+    // Opaque backend handles (EGLDisplay / EGLContext / OSMesaContext)
+    void* display;
+    void* context;
+    unsigned char osmesaPixel[4]; // OSMesa insists on a color buffer; we never draw to it
+};
+
+#endif // HEADLESS_CONTEXT_H
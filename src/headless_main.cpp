@@ -0,0 +1,255 @@
+// Headless renderer: runs the simulation and scene renderer without a window,
+// for regression images and batch export on machines with no display.
+//
+//   pglms_headless [--frames N] [--width W] [--height H] [--fps F] [--seed S]
+//                  [--heatmap] [--backend auto|egl|osmesa] [--output last.ppm]
+//                  [--record path --format qoi|png|y4m] [--trace trace.json]
+//                  [--load-profile curves|meters.csv] [--profile-speed X]
+//                  [--resume in.ckpt] [--checkpoint out.ckpt]
+//
+// The simulation is stepped synchronously (1 kHz, F frames per simulated
+// second) so a given seed always produces the same images.
+// --load-profile replaces the synthetic load with typical day curves or
+// recorded meter data (see load_profile.h), played --profile-speed times
+// faster than the simulation clock.
+// --resume starts from a checkpoint of an earlier run on the same grid and
+// --checkpoint saves the state after the last frame (see checkpoint.h), so a
+// long scenario can be rendered in pieces with the same result.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "checkpoint.h"
+#include "cli_args.h"
+#include "frame_capture.h"
+#include "gl_resource.h"
+#include "gpu_timer.h"
+#include "headless_context.h"
+#include "load_profile.h"
+#include "profiler.h"
+#include "render_target.h"
+#include "scene_renderer.h"
+#include "simulation.h"
+
+struct HeadlessOptions {
+    int frames = 600;
+    int width = 960;
+    int height = 540;
+    double fps = 60.0;
+    uint64_t seed = 1;
+    bool heatmap = false;
+    HeadlessContext::Backend backend = HeadlessContext::AUTO;
+    std::string output;
+    std::string trace;  // Chrome trace JSON of the whole run
+    std::string record; // Directory (qoi/png) or file (y4m) for every frame
+    CaptureFormat format = CaptureFormat::QOI;
+    std::string loadProfile; // "curves" or a meter CSV; empty: synthetic sine wave
+    double profileSpeed = 1.0;
+    std::string resume;     // Checkpoint to start from
+    std::string checkpoint; // Where to save the state after the last frame
+};
+
+static bool ParseOptions(int argc, char** argv, HeadlessOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (arg == "--frames" && hasValue) valid = ParseNumber(argv[++i], options.frames);
+        else if (arg == "--width" && hasValue) valid = ParseNumber(argv[++i], options.width);
+        else if (arg == "--height" && hasValue) valid = ParseNumber(argv[++i], options.height);
+        else if (arg == "--fps" && hasValue) valid = ParseNumber(argv[++i], options.fps);
+        else if (arg == "--seed" && hasValue) valid = ParseNumber(argv[++i], options.seed);
+        else if (arg == "--output" && hasValue) options.output = argv[++i];
+        else if (arg == "--trace" && hasValue) options.trace = argv[++i];
+        else if (arg == "--record" && hasValue) options.record = argv[++i];
+        else if (arg == "--heatmap") options.heatmap = true;
+        else if (arg == "--load-profile" && hasValue) options.loadProfile = argv[++i];
+        else if (arg == "--profile-speed" && hasValue) valid = ParseNumber(argv[++i], options.profileSpeed);
+        else if (arg == "--resume" && hasValue) options.resume = argv[++i];
+        else if (arg == "--checkpoint" && hasValue) options.checkpoint = argv[++i];
+        else if (arg == "--format" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "png") options.format = CaptureFormat::PNG;
+            else if (name == "y4m") options.format = CaptureFormat::Y4M;
+            else options.format = CaptureFormat::QOI;
+        }
+        else if (arg == "--backend" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "egl") options.backend = HeadlessContext::EGL;
+            else if (name == "osmesa") options.backend = HeadlessContext::OSMESA;
+            else options.backend = HeadlessContext::AUTO;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+        if (!valid) {
+            std::cerr << "Bad value for " << arg << ": " << argv[i] << "\n";
+            return false;
+        }
+    }
+    return options.frames > 0 && options.width > 0 && options.height > 0 && options.fps > 0.0;
+}
+
+// Binary PPM (P6), flipping the bottom-up RGBA rows from glReadPixels
+static bool WritePPM(const std::string& path, const std::vector<uint8_t>& rgba, int width, int height)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    for (int y = height - 1; y >= 0; --y) {
+        const uint8_t* src = &rgba[static_cast<size_t>(y) * width * 4];
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "usage: pglms_headless [--frames N] [--width W] [--height H] [--fps F] [--seed S]\n"
+                     "                      [--heatmap] [--backend auto|egl|osmesa] [--output last.ppm]\n"
+                     "                      [--record path --format qoi|png|y4m] [--trace trace.json]\n"
+                     "                      [--load-profile curves|meters.csv] [--profile-speed X]\n"
+                     "                      [--resume in.ckpt] [--checkpoint out.ckpt]\n";
+        return 1;
+    }
+
+    Profiler::setThreadName("Render");
+
+    HeadlessContext context;
+    if (!context.create(options.backend)) {
+        return -1;
+    }
+    std::cout << context.description() << "\n";
+
+    std::shared_ptr<const GridTopology> topology = std::make_shared<GridTopology>(GridTopology::makeDefault());
+    Simulation simulation(topology, options.seed);
+    LoadProfile loadProfile;
+    if (!options.loadProfile.empty()) {
+        bool opened = options.loadProfile == "curves" ? loadProfile.openCurves(*topology, options.profileSpeed)
+                                                      : loadProfile.openCsv(options.loadProfile, *topology, options.profileSpeed);
+        if (!opened) {
+            return -1;
+        }
+        simulation.setLoadProfile(&loadProfile);
+    }
+    if (!options.resume.empty()) {
+        CheckpointReader reader;
+        if (!reader.openFile(options.resume) || !simulation.restoreCheckpoint(reader)) {
+            return -1;
+        }
+        printf("Resumed from %s at %.2f s\n", options.resume.c_str(), simulation.time());
+    }
+    const double stepRate = 1000.0;
+    const int stepsPerFrame = std::max(1, static_cast<int>(stepRate / options.fps + 0.5));
+
+    RenderTarget target(options.width, options.height);
+    PixelReadback readback(options.width, options.height);
+    SceneRenderer renderer(*topology);
+    renderer.heatmapMode = options.heatmap;
+
+    FrameCapture capture;
+    if (!options.record.empty() &&
+        !capture.start(options.record, options.format, options.width, options.height, static_cast<int>(options.fps + 0.5))) {
+        return -1;
+    }
+
+    GpuTimerPool gpuTimers;
+    SimSnapshot snapshot;
+    std::vector<uint8_t> pixels;
+    uint64_t collectedFrame = 0;
+    bool haveFrame = false;
+    // Keep the newest frame that made it back; a lost readback leaves `pixels` as is
+    auto collectFrame = [&]() {
+        uint64_t frameId;
+        if (readback.collect(pixels, frameId, true) == ReadbackStatus::Ready) {
+            collectedFrame = frameId;
+            haveFrame = true;
+        }
+    };
+
+    glClearColor(0.1f, 0.3f, 0.15f, 1.0f);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options.frames; ++frame) {
+        for (int i = 0; i < stepsPerFrame; ++i) {
+            simulation.step(1.0 / stepRate);
+        }
+        simulation.fillSnapshot(snapshot);
+
+        Profiler::markFrame();
+        gpuTimers.beginFrame();
+        target.bind();
+        {
+            PROFILE_SCOPE("Scene draw");
+            GpuScope gpuScope(&gpuTimers, "Scene draw");
+            glClear(GL_COLOR_BUFFER_BIT);
+            renderer.draw(snapshot);
+        }
+
+        // Readback runs a few frames behind; only block when every PBO is in flight
+        if (readback.full()) {
+            collectFrame();
+        }
+        readback.capture(static_cast<uint64_t>(frame));
+
+        if (capture.recording()) {
+            capture.captureFrame();
+        }
+        GlDeletionQueue::drain();
+    }
+    while (!readback.empty()) {
+        collectFrame();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    capture.stop();
+
+    if (!options.checkpoint.empty()) {
+        CheckpointWriter writer;
+        simulation.saveCheckpoint(writer);
+        if (!writer.writeFile(options.checkpoint)) {
+            return -1;
+        }
+    }
+
+    printf("Rendered %d frames at %dx%d in %.3f s (%.1f FPS), simulated %.2f s\n",
+           options.frames, options.width, options.height, seconds, options.frames / seconds, simulation.time());
+
+    if (!options.record.empty()) {
+        CaptureStats stats = capture.stats();
+        printf("Recorded %llu frames to %s (%.3f ms/frame on the render thread, %llu readback stalls, %llu lost)\n",
+               (unsigned long long)stats.framesWritten, options.record.c_str(), stats.renderThreadMs,
+               (unsigned long long)stats.readbackStalls, (unsigned long long)stats.framesLost);
+    }
+
+    if (!options.trace.empty() && Profiler::exportChromeTrace(options.trace)) {
+        printf("Wrote profile trace to %s\n", options.trace.c_str());
+    }
+
+    if (!options.output.empty()) {
+        if (!haveFrame || !WritePPM(options.output, pixels, options.width, options.height)) {
+            std::cerr << "ERROR::HEADLESS::WRITE_FAILED " << options.output << "\n";
+            return -1;
+        }
+        printf("Wrote frame %llu to %s\n", (unsigned long long)collectedFrame, options.output.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "heatmap.h"
+#include <cstddef> // offsetof
+#include "render_stats.h"
+
+// Single channel float texture with an FBO rendering into it
+static void createHeatTarget(int width, int height, GlTexture& texture, GlFramebuffer& framebuffer)
+{
+    texture = GlTexture::create();
+    glBindTexture(GL_TEXTURE_2D, texture.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    framebuffer = GlFramebuffer::create();
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.get(), 0);
+}
+
+Heatmap::Heatmap(int width, int height)
+    : maxValue(1.0f), opacity(0.75f), width(width), height(height), pointCapacity(0),
+      splatShader("Shaders/heatmap_splat.vs", "Shaders/heatmap_splat.fs"),
+      blurShader("Shaders/heatmap.vs", "Shaders/heatmap_blur.fs"),
+      resolveShader("Shaders/heatmap.vs", "Shaders/heatmap.fs")
+{
+    GLint previousFBO;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+    createHeatTarget(width, height, heatTexture, FBO);
+    createHeatTarget(width, height, blurTexture, blurFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+
+    // Point buffer: vec2 position + float weight, interleaved (matches HeatPoint)
+    pointVAO = GlVertexArray::create();
+    pointVBO = GlBuffer::create();
+    glBindVertexArray(pointVAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, pointVBO.get());
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HeatPoint), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(HeatPoint), (void*)offsetof(HeatPoint, weight));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    screenVAO = GlVertexArray::create();
+}
+
+void Heatmap::splat(const HeatPoint* points, size_t count, float radius)
+{
+    // Upload points, orphaning the old storage so the driver never has to sync
+    glBindBuffer(GL_ARRAY_BUFFER, pointVBO.get());
+    if (count > pointCapacity) {
+        pointCapacity = count;
+    }
+    glBufferData(GL_ARRAY_BUFFER, pointCapacity * sizeof(HeatPoint), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(HeatPoint), points);
+
+    // Remember the caller's target, which is not necessarily the default framebuffer
+    GLint viewport[4], previousFBO;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO.get());
+    glViewport(0, 0, width, height);
+    const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, zero); // Leaves the scene's glClearColor untouched
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    splatShader.use();
+    splatShader.setFloat("uPointSize", radius * width); // NDC radius -> texel diameter
+    glBindVertexArray(pointVAO.get());
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(count));
+    FrameRenderStats().record(GL_POINTS, count);
+
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    glDisable(GL_BLEND);
+
+    // Separable blur at heat resolution: heat -> blur (horizontal), blur -> heat (vertical)
+    blurShader.use();
+    blurShader.setInt("uHeat", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(screenVAO.get());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, blurFBO.get());
+    glBindTexture(GL_TEXTURE_2D, heatTexture.get());
+    blurShader.setVec2("uStep", glm::vec2(1.0f / width, 0.0f));
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    FrameRenderStats().record(GL_TRIANGLES, 3);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO.get());
+    glBindTexture(GL_TEXTURE_2D, blurTexture.get());
+    blurShader.setVec2("uStep", glm::vec2(0.0f, 1.0f / height));
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    FrameRenderStats().record(GL_TRIANGLES, 3);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void Heatmap::draw()
+{
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    resolveShader.use();
+    resolveShader.setInt("uHeat", 0);
+    resolveShader.setFloat("uMaxValue", maxValue);
+    resolveShader.setFloat("uOpacity", opacity);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, heatTexture.get());
+    glBindVertexArray(screenVAO.get());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    FrameRenderStats().record(GL_TRIANGLES, 3);
+
+    glDisable(GL_BLEND);
+}
@@ -0,0 +1,49 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <cstddef>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "gl_resource.h"
+#include "shader.h"
+
+// One zone's contribution to the heatmap: NDC position and normalized load (0..1)
+struct HeatPoint {
+    glm::vec2 position;
+    float weight;
+};
+
+// Load heatmap overlay.
+// Zone loads are splatted as additive point sprites into a low resolution R32F
+// texture and blurred there (separable, two passes), so the full-screen pass
+// only does one bilinear fetch and the color map per pixel.
+class Heatmap
+{
+public:
+    Heatmap(int width, int height);
+
+    // Accumulate all points into the heat texture (replaces the previous contents)
+    void splat(const HeatPoint* points, size_t count, float radius);
+
+    // Blend the color-mapped heat texture over the current framebuffer
+    void draw();
+
+    float maxValue; // Heat value mapped to the top of the color ramp
+    float opacity;
+
+private:
+    int width, height;
+
+    GlTexture heatTexture, blurTexture; // Ping-pong pair for the separable blur
+    GlFramebuffer FBO, blurFBO;
+    GlVertexArray pointVAO;
+    GlBuffer pointVBO;
+    GlVertexArray screenVAO; // Empty VAO for the full-screen triangle
+    size_t pointCapacity;
+
+    Shader splatShader;
+    Shader blurShader;
+    Shader resolveShader;
+};
+
+#endif // HEATMAP_H
@@ -0,0 +1,223 @@
+#include "image_encoders.h"
+#include <algorithm>
+#include <cstring>
+
+// Pointer to the first pixel of image row `y` counted from the top
+static inline const uint8_t* topDownRow(const uint8_t* rgba, int width, int height, int y)
+{
+    return rgba + static_cast<size_t>(height - 1 - y) * width * 4;
+}
+
+static inline void putBE32(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// --- QOI ---
+
+void EncodeQOI(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out)
+{
+    const uint8_t OP_INDEX = 0x00, OP_DIFF = 0x40, OP_LUMA = 0x80, OP_RUN = 0xc0, OP_RGB = 0xfe;
+
+    out.reserve(out.size() + 14 + static_cast<size_t>(width) * height * 4 + 8); // Worst case
+    out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+    putBE32(out, static_cast<uint32_t>(width));
+    putBE32(out, static_cast<uint32_t>(height));
+    out.push_back(3); // RGB
+    out.push_back(0); // sRGB with linear alpha
+
+    // As the spec's decoder sees them: index slots start as (0,0,0,0) and the
+    // previous pixel as opaque black. Every encoded pixel is opaque, so a
+    // slot still zeroed never matches
+    uint8_t index[64][4] = {};
+    uint8_t prev[3] = { 0, 0, 0 };
+    int run = 0;
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = topDownRow(rgba, width, height, y);
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* px = row + x * 4;
+            bool last = (y == height - 1) && (x == width - 1);
+
+            if (px[0] == prev[0] && px[1] == prev[1] && px[2] == prev[2]) {
+                ++run;
+                if (run == 62 || last) {
+                    out.push_back(static_cast<uint8_t>(OP_RUN | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                out.push_back(static_cast<uint8_t>(OP_RUN | (run - 1)));
+                run = 0;
+            }
+
+            int hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + 255 * 11) % 64;
+            if (index[hash][0] == px[0] && index[hash][1] == px[1] && index[hash][2] == px[2] && index[hash][3] == 255) {
+                out.push_back(static_cast<uint8_t>(OP_INDEX | hash));
+            } else {
+                index[hash][0] = px[0]; index[hash][1] = px[1]; index[hash][2] = px[2]; index[hash][3] = 255;
+
+                int8_t dr = static_cast<int8_t>(px[0] - prev[0]);
+                int8_t dg = static_cast<int8_t>(px[1] - prev[1]);
+                int8_t db = static_cast<int8_t>(px[2] - prev[2]);
+                int8_t drdg = static_cast<int8_t>(dr - dg);
+                int8_t dbdg = static_cast<int8_t>(db - dg);
+
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    out.push_back(static_cast<uint8_t>(OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                } else if (dg >= -32 && dg <= 31 && drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7) {
+                    out.push_back(static_cast<uint8_t>(OP_LUMA | (dg + 32)));
+                    out.push_back(static_cast<uint8_t>((drdg + 8) << 4 | (dbdg + 8)));
+                } else {
+                    out.push_back(OP_RGB);
+                    out.push_back(px[0]); out.push_back(px[1]); out.push_back(px[2]);
+                }
+            }
+            prev[0] = px[0]; prev[1] = px[1]; prev[2] = px[2];
+        }
+    }
+    out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 }); // End marker
+}
+
+// --- PNG ---
+
+struct Crc32Table {
+    uint32_t entries[256];
+    Crc32Table()
+    {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+    }
+};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length)
+{
+    static const Crc32Table table; // Thread-safe one-time init; encoders run on worker threads
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void putChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t length)
+{
+    putBE32(out, static_cast<uint32_t>(length));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + length);
+    putBE32(out, crc32Update(0, &out[start], length + 4));
+}
+
+void EncodePNG(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    out.insert(out.end(), signature, signature + 8);
+
+    std::vector<uint8_t> header;
+    putBE32(header, static_cast<uint32_t>(width));
+    putBE32(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8-bit RGB, no interlace
+    putChunk(out, "IHDR", header.data(), header.size());
+
+    // Filtered scanlines: filter byte 0 (None) + RGB
+    size_t rowBytes = static_cast<size_t>(width) * 3 + 1;
+    std::vector<uint8_t> raw(rowBytes * height);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = topDownRow(rgba, width, height, y);
+        uint8_t* dst = &raw[y * rowBytes];
+        *dst++ = 0;
+        for (int x = 0; x < width; ++x) {
+            *dst++ = src[x * 4 + 0];
+            *dst++ = src[x * 4 + 1];
+            *dst++ = src[x * 4 + 2];
+        }
+    }
+
+    // zlib stream made of stored deflate blocks (max 65535 bytes each)
+    std::vector<uint8_t> zlib;
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    uint32_t adlerA = 1, adlerB = 0;
+    size_t offset = 0;
+    do {
+        size_t length = std::min<size_t>(65535, raw.size() - offset);
+        bool final = offset + length == raw.size();
+        zlib.push_back(final ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(length));
+        zlib.push_back(static_cast<uint8_t>(length >> 8));
+        zlib.push_back(static_cast<uint8_t>(~length));
+        zlib.push_back(static_cast<uint8_t>(~length >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+        for (size_t i = offset; i < offset + length; ++i) {
+            adlerA = (adlerA + raw[i]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        offset += length;
+    } while (offset < raw.size());
+    putBE32(zlib, (adlerB << 16) | adlerA);
+
+    putChunk(out, "IDAT", zlib.data(), zlib.size());
+    putChunk(out, "IEND", nullptr, 0);
+}
+
+// --- Y4M ---
+
+std::string Y4MHeader(int width, int height, int fps)
+{
+    return "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) +
+           " F" + std::to_string(fps) + ":1 Ip A1:1 C420jpeg\n";
+}
+
+void EncodeY4MFrame(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out)
+{
+    static const char frameTag[] = "FRAME\n";
+    const size_t tagSize = sizeof(frameTag) - 1;
+
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    size_t ySize = static_cast<size_t>(width) * height;
+    size_t cSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    size_t base = out.size();
+    out.resize(base + tagSize + ySize + 2 * cSize); // One resize for tag and planes
+    memcpy(&out[base], frameTag, tagSize);
+    uint8_t* yPlane = &out[base + tagSize];
+    uint8_t* uPlane = yPlane + ySize;
+    uint8_t* vPlane = uPlane + cSize;
+
+    // BT.601 full range, 16.16 fixed point
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = topDownRow(rgba, width, height, y);
+        uint8_t* dst = yPlane + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* px = row + x * 4;
+            dst[x] = static_cast<uint8_t>((19595 * px[0] + 38470 * px[1] + 7471 * px[2] + 32768) >> 16);
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; ++cy) {
+        int y0 = cy * 2, y1 = std::min(y0 + 1, height - 1);
+        const uint8_t* row0 = topDownRow(rgba, width, height, y0);
+        const uint8_t* row1 = topDownRow(rgba, width, height, y1);
+        for (int cx = 0; cx < chromaWidth; ++cx) {
+            int x0 = cx * 2 * 4, x1 = std::min(cx * 2 + 1, width - 1) * 4;
+            int r = row0[x0] + row0[x1] + row1[x0] + row1[x1];
+            int g = row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1];
+            int b = row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2];
+            // Sums are 4x the average: fold the /4 into the shift
+            int u = ((-11059 * r - 21709 * g + 32768 * b) >> 18) + 128;
+            int v = ((32768 * r - 27439 * g - 5329 * b) >> 18) + 128;
+            uPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::clamp(u, 0, 255));
+            vPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::clamp(v, 0, 255));
+        }
+    }
+}
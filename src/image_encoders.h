@@ -0,0 +1,23 @@
+#ifndef IMAGE_ENCODERS_H
+#define IMAGE_ENCODERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame encoders for the capture subsystem. All of them take tightly packed,
+// bottom-up RGBA8 rows exactly as glReadPixels returns them, and append the
+// encoded bytes to `out`. Alpha is dropped.
+
+// QOI (qoiformat.org): lossless, fast, typically 3-5x smaller than raw for UI-like frames
+void EncodeQOI(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out);
+
+// PNG with stored (uncompressed) deflate blocks: no zlib dependency, cheap to
+// produce, readable everywhere; compress afterwards if size matters.
+void EncodePNG(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out);
+
+// YUV4MPEG2 stream: write the header once, then one FRAME per capture (I420, full range)
+std::string Y4MHeader(int width, int height, int fps);
+void EncodeY4MFrame(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out);
+
+#endif // IMAGE_ENCODERS_H
@@ -0,0 +1,288 @@
+#include "load_profile.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// --- Typical day curves ---
+// Hourly load relative to maxLoad, from midnight; interpolated in between.
+
+static const int hoursPerDay = 24;
+static const int loadClassCount = 3;
+
+static const float dailyCurves[loadClassCount][hoursPerDay] = {
+    // Residential: morning bump, evening peak
+    { 0.35f, 0.30f, 0.28f, 0.27f, 0.28f, 0.33f, 0.45f, 0.60f, 0.58f, 0.50f, 0.45f, 0.45f,
+      0.47f, 0.45f, 0.45f, 0.48f, 0.58f, 0.75f, 0.90f, 0.95f, 0.88f, 0.75f, 0.58f, 0.45f },
+    // Commercial: office hours
+    { 0.30f, 0.28f, 0.27f, 0.27f, 0.28f, 0.30f, 0.40f, 0.60f, 0.80f, 0.90f, 0.93f, 0.95f,
+      0.93f, 0.95f, 0.95f, 0.92f, 0.88f, 0.78f, 0.60f, 0.48f, 0.40f, 0.36f, 0.33f, 0.31f },
+    // Industrial: shifts around the clock, heavier by day
+    { 0.70f, 0.68f, 0.68f, 0.68f, 0.70f, 0.75f, 0.85f, 0.92f, 0.95f, 0.95f, 0.95f, 0.93f,
+      0.90f, 0.93f, 0.95f, 0.95f, 0.93f, 0.88f, 0.80f, 0.75f, 0.73f, 0.72f, 0.71f, 0.70f },
+};
+
+const char* LoadProfile::className(LoadClass loadClass)
+{
+    switch (loadClass) {
+        case LoadClass::Residential: return "Residential";
+        case LoadClass::Commercial: return "Commercial";
+        case LoadClass::Industrial: return "Industrial";
+    }
+    return "Unknown";
+}
+
+// --- LoadProfile ---
+
+LoadProfile::LoadProfile()
+    : source(Source::None), timeScale(1.0), zoneCount(0), fileLine(0), meters(0), chunkRows(0),
+      current(0), filled(0), cursor(0), holdingChunk(false), stopping(false),
+      timeBefore(0.0), timeAfter(0.0), firstTime(0.0), exhausted(false), rowsConsumed(0), stalls(0)
+{
+}
+
+LoadProfile::~LoadProfile()
+{
+    close();
+}
+
+void LoadProfile::close()
+{
+    if (reader.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        chunkReleased.notify_one();
+        reader.join();
+    }
+    file.close();
+    source = Source::None;
+}
+
+bool LoadProfile::openCurves(const GridTopology& grid, double scale)
+{
+    close();
+    source = Source::Curves;
+    timeScale = scale;
+    zoneCount = grid.zoneCount();
+    maxLoad = grid.maxLoad;
+
+    // Hashed like the priority tiers, so neighbouring zones mix
+    zoneClass.resize(zoneCount);
+    for (size_t i = 0; i < zoneCount; ++i) {
+        uint32_t classHash = ((static_cast<uint32_t>(i) + 0x9e3779b9u) * 2654435761u) >> 16;
+        uint32_t bucket = classHash % 20;
+        zoneClass[i] = bucket < 12 ? LoadClass::Residential : (bucket < 17 ? LoadClass::Commercial : LoadClass::Industrial);
+    }
+    return true;
+}
+
+bool LoadProfile::openCsv(const std::string& csvPath, const GridTopology& grid, double scale, size_t chunkBytes)
+{
+    close();
+    path = csvPath;
+    timeScale = scale;
+    zoneCount = grid.zoneCount();
+
+    // A large stream buffer; the reader thread does its own read-ahead on top
+    fileBuffer.resize(1 << 20);
+    file.rdbuf()->pubsetbuf(fileBuffer.data(), static_cast<std::streamsize>(fileBuffer.size()));
+    file.clear();
+    file.open(path);
+    if (!file || !std::getline(file, line)) {
+        std::cerr << "ERROR::LOAD_PROFILE::FILE_NOT_READ " << path << "\n";
+        return false;
+    }
+    fileLine = 1;
+
+    // The header names the time column and one column per meter
+    meters = static_cast<size_t>(std::count(line.begin(), line.end(), ','));
+    if (meters == 0) {
+        std::cerr << "ERROR::LOAD_PROFILE::NO_METERS " << path << "\n";
+        return false;
+    }
+    chunkRows = std::max<size_t>(1, chunkBytes / (meters * sizeof(float)));
+    for (Chunk& chunk : chunks) {
+        chunk.times.resize(chunkRows);
+        chunk.values.resize(chunkRows * meters);
+        chunk.rows = 0;
+        chunk.last = false;
+    }
+    rowBefore.assign(meters, 0.0f);
+    rowAfter.assign(meters, 0.0f);
+
+    current = 0;
+    filled = 0;
+    cursor = 0;
+    holdingChunk = false;
+    stopping = false;
+    exhausted = false;
+    rowsConsumed = 0;
+    source = Source::Csv;
+    reader = std::thread(&LoadProfile::readChunks, this);
+
+    // Both rows start at the first one, so the profile starts at its first time
+    if (!nextRow()) {
+        std::cerr << "ERROR::LOAD_PROFILE::NO_ROWS " << path << "\n";
+        close();
+        return false;
+    }
+    rowBefore = rowAfter;
+    timeBefore = timeAfter;
+    firstTime = timeAfter;
+    stalls = 0;
+    return true;
+}
+
+// --- Reader thread ---
+
+void LoadProfile::readChunks()
+{
+    Profiler::setThreadName("Load profile reader");
+    for (;;) {
+        size_t target;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkReleased.wait(lock, [this] { return stopping || filled < chunkCount; });
+            if (stopping) {
+                return;
+            }
+            target = (current + filled) % chunkCount; // Only this thread touches it until it is handed over
+        }
+
+        Chunk& chunk = chunks[target];
+        bool more;
+        {
+            PROFILE_SCOPE("Read load profile chunk");
+            more = readChunk(chunk);
+        }
+        chunk.last = !more;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++filled;
+        }
+        chunkFilled.notify_one();
+        if (!more) {
+            return;
+        }
+    }
+}
+
+// Parse up to chunkRows rows; false at the end of the file or at a bad row
+bool LoadProfile::readChunk(Chunk& chunk)
+{
+    chunk.rows = 0;
+    while (chunk.rows < chunkRows && std::getline(file, line)) {
+        ++fileLine;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        const char* text = line.c_str();
+        char* end = nullptr;
+        double time = std::strtod(text, &end);
+        bool valid = end != text;
+        float* row = &chunk.values[chunk.rows * meters];
+        for (size_t m = 0; valid && m < meters; ++m) {
+            text = end;
+            valid = *text == ',';
+            row[m] = std::strtof(text + 1, &end);
+            valid = valid && end != text + 1;
+        }
+        if (!valid) {
+            std::cerr << "ERROR::LOAD_PROFILE::BAD_ROW " << path << ":" << fileLine << "\n";
+            return false;
+        }
+        chunk.times[chunk.rows++] = time;
+    }
+    return chunk.rows == chunkRows;
+}
+
+// --- Simulation side ---
+
+// Shift rowAfter into rowBefore and read the next row into rowAfter; false
+// (rows unchanged) once the file is exhausted
+bool LoadProfile::nextRow()
+{
+    for (;;) {
+        if (holdingChunk && cursor < chunks[current].rows) {
+            break;
+        }
+        if (holdingChunk) {
+            bool last = chunks[current].last;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                current = (current + 1) % chunkCount;
+                --filled;
+            }
+            chunkReleased.notify_one();
+            holdingChunk = false;
+            cursor = 0;
+            if (last) {
+                exhausted = true;
+                return false;
+            }
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (filled == 0) {
+            ++stalls; // Read-ahead fell behind
+            chunkFilled.wait(lock, [this] { return filled > 0; });
+        }
+        holdingChunk = true;
+    }
+
+    const Chunk& chunk = chunks[current];
+    std::swap(rowBefore, rowAfter);
+    timeBefore = timeAfter;
+    const float* row = &chunk.values[cursor * meters];
+    std::copy(row, row + meters, rowAfter.begin());
+    timeAfter = chunk.times[cursor];
+    ++cursor;
+    ++rowsConsumed;
+    return true;
+}
+
+void LoadProfile::sample(double time, float* out)
+{
+    if (source == Source::Curves) {
+        // One interpolation per class, then a gather per zone
+        double hour = std::fmod(time * timeScale / 3600.0, static_cast<double>(hoursPerDay));
+        int h0 = std::min(static_cast<int>(hour), hoursPerDay - 1);
+        int h1 = (h0 + 1) % hoursPerDay;
+        float weight = static_cast<float>(hour - h0);
+        float classLoad[loadClassCount];
+        for (int c = 0; c < loadClassCount; ++c) {
+            classLoad[c] = dailyCurves[c][h0] + (dailyCurves[c][h1] - dailyCurves[c][h0]) * weight;
+        }
+        const LoadClass* classes = zoneClass.data();
+        const float* zoneMax = maxLoad.data();
+        for (size_t i = 0; i < zoneCount; ++i) {
+            out[i] = zoneMax[i] * classLoad[static_cast<int>(classes[i])];
+        }
+        return;
+    }
+    if (source != Source::Csv) {
+        std::fill(out, out + zoneCount, 0.0f);
+        return;
+    }
+
+    PROFILE_SCOPE("Sample load profile");
+    double profileTime = firstTime + time * timeScale;
+    while (!exhausted && profileTime >= timeAfter) {
+        nextRow();
+    }
+    double span = timeAfter - timeBefore;
+    float weight = span > 0.0 ? static_cast<float>(std::clamp((profileTime - timeBefore) / span, 0.0, 1.0)) : 1.0f;
+
+    // Lerp meter by meter; zones past the last meter wrap around to the first
+    const float* before = rowBefore.data();
+    const float* after = rowAfter.data();
+    for (size_t base = 0; base < zoneCount; base += meters) {
+        const size_t n = std::min(meters, zoneCount - base);
+        float* zoneLoad = out + base;
+        for (size_t m = 0; m < n; ++m) {
+            zoneLoad[m] = before[m] + (after[m] - before[m]) * weight;
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef LOAD_PROFILE_H
+#define LOAD_PROFILE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation.h"
+
+// Per-zone load over time, in place of the synthetic sine wave.
+//
+// Two sources:
+//  * Curves: a typical day for residential, commercial and industrial zones
+//    (hourly values relative to maxLoad, interpolated and repeated every 24 h).
+//    Zones get a class from their index: about 60% residential, 25%
+//    commercial, 15% industrial.
+//  * CSV meter data: a header line, then rows of `time, meter 1, meter 2, ...`
+//    with time in seconds (increasing) and loads in the same units as maxLoad.
+//    Zone i reads meter i % meters, so a small file can drive a large grid.
+//    After the last row the loads hold their last value.
+//
+// The CSV is never loaded whole: a reader thread parses it about chunkBytes
+// of loads at a time into a ring of chunkCount chunks ahead of the simulation
+// (read-ahead), and sample() only keeps the two rows around the current time.
+// Interpolating between them is one lerp per zone over contiguous arrays.
+//
+// Profile time is `time * timeScale` from the first row (or midnight for the
+// curves): a timeScale of 3600 plays an hour of data per simulated second.
+// sample() is for the simulation thread only.
+
+enum class LoadClass : uint8_t {
+    Residential,
+    Commercial,
+    Industrial
+};
+
+class LoadProfile
+{
+public:
+    LoadProfile();
+    ~LoadProfile();
+    LoadProfile(const LoadProfile&) = delete;
+    LoadProfile& operator=(const LoadProfile&) = delete;
+
+    bool openCurves(const GridTopology& grid, double timeScale = 1.0);
+    // False (after printing the reason) if the file cannot be read or has no meters
+    bool openCsv(const std::string& path, const GridTopology& grid, double timeScale = 1.0, size_t chunkBytes = 16 << 20);
+
+    // Load of every zone at simulated `time` into out[0, zoneCount)
+    void sample(double time, float* out);
+
+    size_t meterCount() const { return meters; }
+    uint64_t rowsRead() const { return rowsConsumed; }
+    uint64_t readerStalls() const { return stalls; } // Samples that had to wait for the reader thread
+
+    static const char* className(LoadClass loadClass);
+
+private:
+    enum class Source : uint8_t { None, Curves, Csv };
+
+    struct Chunk {
+        std::vector<double> times;
+        std::vector<float> values; // rows x meters, one row per time
+        size_t rows = 0;
+        bool last = false;         // No rows after this chunk
+    };
+    static constexpr size_t chunkCount = 3;
+
+    Source source;
+    double timeScale;
+    size_t zoneCount;
+
+    // --- Curves ---
+    std::vector<LoadClass> zoneClass;
+    std::vector<float> maxLoad;
+
+    // --- CSV ---
+    std::ifstream file;
+    std::vector<char> fileBuffer;
+    std::string path;
+    std::string line; // Reader thread; keeps its capacity
+    uint64_t fileLine;
+    size_t meters;
+    size_t chunkRows;
+    Chunk chunks[chunkCount];
+    size_t current;     // Chunk the simulation reads from
+    size_t filled;      // Chunks handed over by the reader, counting `current`
+    size_t cursor;      // Next row in `current`
+    bool holdingChunk;  // The simulation has `current` (false before the first row)
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable chunkFilled;
+    std::condition_variable chunkReleased;
+    std::thread reader;
+
+    // The two rows around the current time
+    std::vector<float> rowBefore, rowAfter;
+    double timeBefore, timeAfter;
+    double firstTime;
+    bool exhausted;
+    uint64_t rowsConsumed;
+    uint64_t stalls;
+
+    void readChunks();
+    bool readChunk(Chunk& chunk);
+    bool nextRow();
+    void close();
+};
+
+#endif // LOAD_PROFILE_H
@@ -0,0 +1,213 @@
+#include "mesh_registry.h"
+#include "gl_features.h"
+#include "render_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Instance attribute locations (after the layout's position and color)
+static const GLuint offsetAttribute = 2;
+static const GLuint scaleAttribute = 3;
+static const GLuint instanceColorAttribute = 4;
+
+MeshRegistry::MeshRegistry(const VertexLayout& layout)
+    : layout(layout), indexType(GL_UNSIGNED_INT), vertexBytes(0), indexBytes(0),
+      instanceCapacity(0), commandCapacity(0), openScale(1.0f)
+{
+}
+
+MeshId MeshRegistry::add(const std::vector<float>& vertices, const std::vector<GLuint>& indices)
+{
+    PackedVertices packed = PackVertices(vertices, std::vector<float>(), layout);
+
+    MeshRange range;
+    range.firstIndex = static_cast<GLuint>(pendingIndices.size());
+    range.indexCount = static_cast<GLuint>(indices.size());
+    range.baseVertex = static_cast<GLint>(pendingVertices.size() / layout.stride());
+    range.positionScale = packed.positionScale;
+    meshes.push_back(range);
+
+    pendingVertices.insert(pendingVertices.end(), packed.bytes.begin(), packed.bytes.end());
+    pendingIndices.insert(pendingIndices.end(), indices.begin(), indices.end());
+    return static_cast<MeshId>(meshes.size() - 1);
+}
+
+void MeshRegistry::upload()
+{
+    // Indices stay local to their mesh (baseVertex does the rest), so the
+    // narrowed type only has to hold the largest mesh's vertex count
+    PackedIndices packedIndices = PackIndices(pendingIndices);
+    indexType = packedIndices.type;
+    vertexBytes = pendingVertices.size();
+    indexBytes = packedIndices.bytes.size();
+
+    VBO = GlBuffer::create();
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+    glBufferData(GL_ARRAY_BUFFER, pendingVertices.size(), pendingVertices.data(), GL_STATIC_DRAW);
+    EBO = GlBuffer::create();
+    instanceBuffer = GlBuffer::create();
+
+    VAO = GlVertexArray::create();
+    glBindVertexArray(VAO.get());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, packedIndices.bytes.size(), packedIndices.bytes.data(), GL_STATIC_DRAW);
+    setupVertexArray(0);
+    glBindVertexArray(0);
+
+    if (GlSupport().multiDrawIndirect) {
+        commandBuffer = GlBuffer::create();
+    }
+
+    pendingVertices = std::vector<uint8_t>();
+    pendingIndices = std::vector<GLuint>();
+}
+
+void MeshRegistry::setupVertexArray(size_t firstInstance)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+    layout.apply();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    glEnableVertexAttribArray(offsetAttribute);
+    glEnableVertexAttribArray(scaleAttribute);
+    glEnableVertexAttribArray(instanceColorAttribute);
+    glVertexAttribDivisor(offsetAttribute, 1);
+    glVertexAttribDivisor(scaleAttribute, 1);
+    glVertexAttribDivisor(instanceColorAttribute, 1);
+    bindInstanceAttributes(firstInstance);
+}
+
+// Point the instance attributes at `firstInstance` (the instance buffer must be bound)
+void MeshRegistry::bindInstanceAttributes(size_t firstInstance)
+{
+    const size_t base = firstInstance * sizeof(MeshInstance);
+    glVertexAttribPointer(offsetAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(MeshInstance),
+                          (void*)(base + offsetof(MeshInstance, offset)));
+    glVertexAttribPointer(scaleAttribute, 1, GL_FLOAT, GL_FALSE, sizeof(MeshInstance),
+                          (void*)(base + offsetof(MeshInstance, scale)));
+    glVertexAttribPointer(instanceColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(MeshInstance),
+                          (void*)(base + offsetof(MeshInstance, color)));
+}
+
+void MeshRegistry::beginFrame()
+{
+    instances.clear();
+    commands.clear();
+}
+
+void MeshRegistry::beginCommand(MeshId mesh)
+{
+    const MeshRange& range = meshes[mesh];
+    commands.push_back({range.indexCount, 0, range.firstIndex, range.baseVertex,
+                        static_cast<GLuint>(instances.size())});
+    openScale = range.positionScale;
+}
+
+void MeshRegistry::addInstance(glm::vec2 offset, float scale, glm::vec3 color)
+{
+    MeshInstance instance;
+    instance.offset = offset;
+    instance.scale = scale * openScale;
+    for (int c = 0; c < 3; ++c) {
+        instance.color[c] = static_cast<uint8_t>(std::lround(std::clamp(color[c], 0.0f, 1.0f) * 255.0f));
+    }
+    instance.color[3] = 255;
+    instances.push_back(instance);
+    ++commands.back().instanceCount;
+}
+
+void MeshRegistry::draw(bool multiDraw)
+{
+    if (instances.empty()) {
+        return;
+    }
+    if (!layout.vertexColor) {
+        glVertexAttrib4f(VertexLayout::colorAttribute, 1.0f, 1.0f, 1.0f, 1.0f); // Context state, not VAO state
+    }
+
+    if (multiDraw && GlSupport().multiDrawIndirect) {
+        drawIndirect();
+    } else {
+        drawPerCommand();
+    }
+    glBindVertexArray(0);
+}
+
+void MeshRegistry::drawIndirect()
+{
+    glBindVertexArray(VAO.get());
+
+    // Orphan and refill the instance buffer (grown by doubling, never shrunk);
+    // baseInstance offsets the instance attributes, so they stay at 0
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    if (instances.size() > instanceCapacity) {
+        instanceCapacity = std::max(instances.size(), instanceCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(MeshInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(MeshInstance), instances.data());
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.get());
+    if (commands.size() > commandCapacity) {
+        commandCapacity = std::max(commands.size(), commandCapacity * 2);
+    }
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commandCapacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+    GlSupport().multiDrawElementsIndirect(GL_TRIANGLES, indexType, nullptr, static_cast<GLsizei>(commands.size()), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    RenderStats& stats = FrameRenderStats();
+    stats.record(GL_TRIANGLES, 0);
+    for (const DrawElementsIndirectCommand& command : commands) {
+        stats.addPrimitives(GL_TRIANGLES, command.count, command.instanceCount);
+    }
+}
+
+// Give every command a region with headroom and point its VAO there
+void MeshRegistry::layoutSlots()
+{
+    while (slots.size() < commands.size()) {
+        slots.push_back({GlVertexArray::create(), 0, 0});
+    }
+    size_t start = 0;
+    for (size_t c = 0; c < slots.size(); ++c) {
+        size_t count = c < commands.size() ? commands[c].instanceCount : 0;
+        slots[c].regionStart = start;
+        slots[c].regionCapacity = std::max<size_t>(count + count / 2, 16);
+        start += slots[c].regionCapacity;
+
+        glBindVertexArray(slots[c].VAO.get());
+        setupVertexArray(slots[c].regionStart);
+    }
+    instanceCapacity = std::max(instanceCapacity, start);
+}
+
+void MeshRegistry::drawPerCommand()
+{
+    bool fits = slots.size() >= commands.size();
+    for (size_t c = 0; fits && c < commands.size(); ++c) {
+        fits = commands[c].instanceCount <= slots[c].regionCapacity;
+    }
+    if (!fits) {
+        layoutSlots();
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(MeshInstance), nullptr, GL_STREAM_DRAW);
+
+    RenderStats& stats = FrameRenderStats();
+    const size_t indexSize = IndexTypeSize(indexType);
+    for (size_t c = 0; c < commands.size(); ++c) {
+        const DrawElementsIndirectCommand& command = commands[c];
+        if (command.instanceCount == 0) {
+            continue;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, slots[c].regionStart * sizeof(MeshInstance),
+                        command.instanceCount * sizeof(MeshInstance), &instances[command.baseInstance]);
+        glBindVertexArray(slots[c].VAO.get());
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, indexType,
+                                          (void*)(command.firstIndex * indexSize),
+                                          command.instanceCount, command.baseVertex);
+        stats.record(GL_TRIANGLES, command.count, command.instanceCount);
+    }
+}
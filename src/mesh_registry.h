@@ -0,0 +1,107 @@
+#ifndef MESH_REGISTRY_H
+#define MESH_REGISTRY_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "gl_resource.h"
+#include "vertex_layout.h"
+
+// Static triangle meshes packed into one shared VBO/IBO, drawn as instances.
+// Meshes are registered up front and uploaded once. Each frame the caller
+// opens one command per mesh (beginCommand) and appends that mesh's
+// instances; draw() uploads the instance and command arrays and submits all
+// commands with a single glMultiDrawElementsIndirect when GlSupport() has it,
+// otherwise with one glDrawElementsInstancedBaseVertex per command (GL 3.3).
+// Commands are drawn in the order they were opened.
+// GL 3.3 has no baseInstance, so the fallback gives every command a fixed
+// region of the instance buffer and its own VAO pointing at it; the pointers
+// only change when a region has to grow (re-pointing attributes every draw
+// makes drivers revalidate the vertex state).
+
+using MeshId = uint32_t;
+
+// Per-instance attributes (16 bytes): offset and scale in NDC, RGBA8 color
+struct MeshInstance {
+    glm::vec2 offset;
+    float scale;
+    uint8_t color[4];
+};
+
+// Layout fixed by GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+class MeshRegistry
+{
+public:
+    explicit MeshRegistry(const VertexLayout& layout);
+
+    // Before upload(): `vertices` are xyz floats, indices are local to the mesh
+    MeshId add(const std::vector<float>& vertices, const std::vector<GLuint>& indices);
+
+    // Pack every registered mesh into the shared buffers and build the VAO
+    void upload();
+
+    size_t meshCount() const { return meshes.size(); }
+    size_t bufferBytes() const { return vertexBytes + indexBytes; } // Shared VBO + IBO
+
+    // --- Per frame ---
+    void beginFrame();
+    void beginCommand(MeshId mesh);
+    void addInstance(glm::vec2 offset, float scale, glm::vec3 color); // Into the open command
+    size_t instanceCount() const { return instances.size(); }
+
+    // Triangles; `multiDraw` = false forces the per-command fallback
+    void draw(bool multiDraw);
+
+private:
+    struct MeshRange {
+        GLuint firstIndex;
+        GLuint indexCount;
+        GLint baseVertex;
+        float positionScale; // Snorm16 meshes are stored divided by their extent
+    };
+
+    VertexLayout layout;
+    std::vector<MeshRange> meshes;
+
+    // Packed vertices and local indices kept until upload()
+    std::vector<uint8_t> pendingVertices;
+    std::vector<GLuint> pendingIndices;
+
+    // Fallback path: one VAO per command, instance attributes at a fixed region
+    struct CommandSlot {
+        GlVertexArray VAO;
+        size_t regionStart;    // In instances
+        size_t regionCapacity;
+    };
+
+    GlVertexArray VAO;
+    GlBuffer VBO, EBO, instanceBuffer, commandBuffer;
+    std::vector<CommandSlot> slots;
+    GLenum indexType;
+    size_t vertexBytes;
+    size_t indexBytes;
+    size_t instanceCapacity; // Instances the GPU buffer holds (grown by doubling)
+    size_t commandCapacity;
+
+    // Rebuilt every frame; both keep their capacity
+    std::vector<MeshInstance> instances;
+    std::vector<DrawElementsIndirectCommand> commands;
+    float openScale; // positionScale of the open command's mesh
+
+    void setupVertexArray(size_t firstInstance); // Mesh buffers + instance attributes for the bound VAO
+    void bindInstanceAttributes(size_t firstInstance);
+    void layoutSlots();
+    void drawIndirect();
+    void drawPerCommand();
+};
+
+#endif // MESH_REGISTRY_H
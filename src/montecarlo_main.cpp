@@ -0,0 +1,423 @@
+// Monte Carlo scenario runner: replays the overload policy on many headless
+// simulation replicas in parallel, so the overload interval, auto-cut timeout,
+// power cut duration and cooldown can be compared on numbers instead of feel.
+//
+//   pglms_montecarlo [--replicas N] [--duration SECONDS] [--dt SECONDS]
+//                    [--zones N] [--seed S] [--threads N]
+//                    [--overload-interval LIST] [--auto-cut LIST]
+//                    [--power-cut LIST] [--cooldown LIST]
+//                    [--policy RULE] [--arm-above RATIO] [--disarm-below RATIO]
+//                    [--rotation-groups N] [--rotation-period SECONDS]
+//                    [--load-profile curves|meters.csv] [--profile-speed X]
+//                    [--resume state.ckpt]
+//                    [--csv replicas.csv] [--json summary.json]
+//
+// Every LIST is comma separated; the policies are all their combinations.
+// Each policy runs --replicas simulations with seeds seed, seed+1, ... (the
+// same seeds for every policy, so differences come from the policy and not
+// from the draw). Nobody answers the operator prompt in batch mode, so
+// overloads end through the auto-cut timeout.
+// --policy adds a shedding rule (see shed_policy.h) to every policy; it is
+// compiled once and shared by all replicas. --load-profile drives the zone
+// loads from typical day curves or meter data (see load_profile.h); every
+// replica streams its own copy.
+// --resume branches every replica from one checkpoint (see checkpoint.h;
+// pass the --zones and --seed it was taken with) instead of a fresh grid:
+// each replica restores it, switches to its own random stream and runs
+// --duration more seconds, and the statistics count from the branch point.
+// Replicas share one immutable GridTopology; all mutable state lives in the
+// replica's own Simulation on the worker thread that runs it, so throughput
+// scales with the core count.
+// Per policy it reports the distribution (mean, p10, p50, p90, max) over
+// replicas of shed energy, outage minutes and overload seconds.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "checkpoint.h"
+#include "cli_args.h"
+#include "load_profile.h"
+#include "profiler.h"
+#include "shed_policy.h"
+#include "simulation.h"
+#include "worker_pool.h"
+
+// --- Options ---
+
+struct MonteCarloOptions {
+    int replicas = 1000;
+    double duration = 600.0; // Simulated seconds per replica
+    double dt = 0.01;        // Coarser than the interactive 1 kHz; the policy timers are seconds
+    size_t zones = 0;        // 0: the four-house demo grid, otherwise a synthetic grid
+    uint64_t seed = 1;
+    unsigned threads = 0;    // 0: one per hardware thread
+    std::vector<double> overloadIntervals = { SimulationParams().overloadInterval };
+    std::vector<double> autoCutTimeouts = { SimulationParams().autoCutTimeout };
+    std::vector<double> powerCutDurations = { SimulationParams().powerCutDuration };
+    std::vector<double> cooldownDurations = { SimulationParams().cooldownDuration };
+    ShedPolicyConfig shedPolicy; // Empty rule: no shedding policy
+    std::string loadProfile;     // "curves" or a meter CSV; empty: synthetic sine wave
+    double profileSpeed = 1.0;
+    std::string resume; // Checkpoint every replica branches from
+    std::string csv;
+    std::string json;
+};
+
+static bool ParseList(const std::string& list, std::vector<double>& values)
+{
+    values.clear();
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        double value = 0.0;
+        if (!ParseNumber(item.c_str(), value) || value < 0.0) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+static bool ParseOptions(int argc, char** argv, MonteCarloOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (arg == "--replicas" && hasValue) valid = ParseNumber(argv[++i], options.replicas);
+        else if (arg == "--duration" && hasValue) valid = ParseNumber(argv[++i], options.duration);
+        else if (arg == "--dt" && hasValue) valid = ParseNumber(argv[++i], options.dt);
+        else if (arg == "--zones" && hasValue) valid = ParseNumber(argv[++i], options.zones);
+        else if (arg == "--seed" && hasValue) valid = ParseNumber(argv[++i], options.seed);
+        else if (arg == "--threads" && hasValue) valid = ParseNumber(argv[++i], options.threads);
+        else if (arg == "--overload-interval" && hasValue) {
+            if (!ParseList(argv[++i], options.overloadIntervals)) return false;
+        }
+        else if (arg == "--auto-cut" && hasValue) {
+            if (!ParseList(argv[++i], options.autoCutTimeouts)) return false;
+        }
+        else if (arg == "--power-cut" && hasValue) {
+            if (!ParseList(argv[++i], options.powerCutDurations)) return false;
+        }
+        else if (arg == "--cooldown" && hasValue) {
+            if (!ParseList(argv[++i], options.cooldownDurations)) return false;
+        }
+        else if (arg == "--policy" && hasValue) options.shedPolicy.rule = argv[++i];
+        else if (arg == "--arm-above" && hasValue) valid = ParseNumber(argv[++i], options.shedPolicy.armAbove);
+        else if (arg == "--disarm-below" && hasValue) valid = ParseNumber(argv[++i], options.shedPolicy.disarmBelow);
+        else if (arg == "--rotation-groups" && hasValue) valid = ParseNumber(argv[++i], options.shedPolicy.rotationGroups);
+        else if (arg == "--rotation-period" && hasValue) valid = ParseNumber(argv[++i], options.shedPolicy.rotationPeriod);
+        else if (arg == "--load-profile" && hasValue) options.loadProfile = argv[++i];
+        else if (arg == "--profile-speed" && hasValue) valid = ParseNumber(argv[++i], options.profileSpeed);
+        else if (arg == "--resume" && hasValue) options.resume = argv[++i];
+        else if (arg == "--csv" && hasValue) options.csv = argv[++i];
+        else if (arg == "--json" && hasValue) options.json = argv[++i];
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+        if (!valid) {
+            std::cerr << "Bad value for " << arg << ": " << argv[i] << "\n";
+            return false;
+        }
+    }
+    return options.replicas > 0 && options.duration > 0.0 && options.dt > 0.0;
+}
+
+// --- Policies and results ---
+
+static std::vector<SimulationParams> MakePolicies(const MonteCarloOptions& options,
+                                                  const std::shared_ptr<const ShedPolicy>& shedPolicy)
+{
+    std::vector<SimulationParams> policies;
+    for (double interval : options.overloadIntervals) {
+        for (double autoCut : options.autoCutTimeouts) {
+            for (double powerCut : options.powerCutDurations) {
+                for (double cooldown : options.cooldownDurations) {
+                    SimulationParams params;
+                    params.overloadInterval = interval;
+                    params.autoCutTimeout = autoCut;
+                    params.powerCutDuration = powerCut;
+                    params.cooldownDuration = cooldown;
+                    params.operatorPrompt = false; // Nobody is there to answer it
+                    params.shedPolicy = shedPolicy;
+                    policies.push_back(params);
+                }
+            }
+        }
+    }
+    return policies;
+}
+
+// Totals accumulated since `base` was taken
+static SimulationStats StatsSince(const SimulationStats& now, const SimulationStats& base)
+{
+    SimulationStats stats;
+    stats.shedEnergy = now.shedEnergy - base.shedEnergy;
+    stats.outageSeconds = now.outageSeconds - base.outageSeconds;
+    stats.overloadSeconds = now.overloadSeconds - base.overloadSeconds;
+    stats.overloadEvents = now.overloadEvents - base.overloadEvents;
+    stats.automaticCuts = now.automaticCuts - base.automaticCuts;
+    stats.manualCuts = now.manualCuts - base.manualCuts;
+    stats.policyCuts = now.policyCuts - base.policyCuts;
+    return stats;
+}
+
+struct ReplicaResult {
+    uint64_t seed = 0;
+    SimulationStats stats;
+};
+
+struct Distribution {
+    double mean = 0.0, p10 = 0.0, p50 = 0.0, p90 = 0.0, max = 0.0;
+};
+
+// Nearest-sample percentiles; sorts `samples`
+static Distribution Summarize(std::vector<double>& samples)
+{
+    Distribution d;
+    if (samples.empty()) {
+        return d;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double p) {
+        size_t rank = static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+        return samples[std::min(rank, samples.size() - 1)];
+    };
+    double sum = 0.0;
+    for (double value : samples) {
+        sum += value;
+    }
+    d.mean = sum / samples.size();
+    d.p10 = at(10.0);
+    d.p50 = at(50.0);
+    d.p90 = at(90.0);
+    d.max = samples.back();
+    return d;
+}
+
+// Reported distributions
+struct MetricField {
+    const char* key;
+    const char* label;
+    double (*value)(const SimulationStats& stats);
+};
+
+static const MetricField metricFields[] = {
+    { "shed_energy", "shed energy", [](const SimulationStats& s) { return s.shedEnergy; } },
+    { "outage_minutes", "outage min", [](const SimulationStats& s) { return s.outageSeconds / 60.0; } },
+    { "overload_seconds", "overload s", [](const SimulationStats& s) { return s.overloadSeconds; } },
+};
+static const int metricCount = sizeof(metricFields) / sizeof(metricFields[0]);
+
+struct PolicySummary {
+    SimulationParams params;
+    Distribution metrics[metricCount];
+    double automaticCuts = 0.0;  // Mean per replica
+    double policyCuts = 0.0;     // Mean per replica
+    double overloadEvents = 0.0; // Mean per replica
+};
+
+// --- Output ---
+
+static bool WriteCsv(const std::string& path, const std::vector<SimulationParams>& policies,
+                     const std::vector<ReplicaResult>& results, int replicas)
+{
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file.precision(12);
+    file << "overload_interval,auto_cut,power_cut,cooldown,seed,shed_energy,outage_seconds,overload_seconds,"
+            "overload_events,automatic_cuts,policy_cuts\n";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const SimulationParams& params = policies[r / replicas];
+        const SimulationStats& stats = results[r].stats;
+        file << params.overloadInterval << "," << params.autoCutTimeout << "," << params.powerCutDuration << ","
+             << params.cooldownDuration << "," << results[r].seed << "," << stats.shedEnergy << ","
+             << stats.outageSeconds << "," << stats.overloadSeconds << "," << stats.overloadEvents << ","
+             << stats.automaticCuts << "," << stats.policyCuts << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+static bool WriteJson(const std::string& path, const MonteCarloOptions& options, size_t zones,
+                      const std::vector<PolicySummary>& summaries)
+{
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file.precision(12);
+    file << "{\n";
+    file << "  \"runner\": \"pglms_montecarlo\",\n";
+    file << "  \"version\": 1,\n";
+    file << "  \"seed\": " << options.seed << ",\n";
+    file << "  \"replicas\": " << options.replicas << ",\n";
+    file << "  \"duration\": " << options.duration << ",\n";
+    file << "  \"dt\": " << options.dt << ",\n";
+    file << "  \"zones\": " << zones << ",\n";
+    file << "  \"shed_policy\": \"" << options.shedPolicy.rule << "\",\n";
+    file << "  \"policies\": [\n";
+    for (size_t p = 0; p < summaries.size(); ++p) {
+        const PolicySummary& summary = summaries[p];
+        file << "    { \"overload_interval\": " << summary.params.overloadInterval
+             << ", \"auto_cut\": " << summary.params.autoCutTimeout
+             << ", \"power_cut\": " << summary.params.powerCutDuration
+             << ", \"cooldown\": " << summary.params.cooldownDuration
+             << ", \"overload_events\": " << summary.overloadEvents
+             << ", \"automatic_cuts\": " << summary.automaticCuts
+             << ", \"policy_cuts\": " << summary.policyCuts;
+        for (int m = 0; m < metricCount; ++m) {
+            const Distribution& d = summary.metrics[m];
+            file << ", \"" << metricFields[m].key << "\": { \"mean\": " << d.mean << ", \"p10\": " << d.p10
+                 << ", \"p50\": " << d.p50 << ", \"p90\": " << d.p90 << ", \"max\": " << d.max << " }";
+        }
+        file << " }" << (p + 1 < summaries.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char** argv)
+{
+    MonteCarloOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "usage: pglms_montecarlo [--replicas N] [--duration SECONDS] [--dt SECONDS] [--zones N]\n"
+                     "                        [--seed S] [--threads N] [--overload-interval LIST] [--auto-cut LIST]\n"
+                     "                        [--power-cut LIST] [--cooldown LIST] [--policy RULE]\n"
+                     "                        [--arm-above RATIO] [--disarm-below RATIO] [--rotation-groups N]\n"
+                     "                        [--rotation-period SECONDS] [--load-profile curves|meters.csv]\n"
+                     "                        [--profile-speed X] [--resume state.ckpt] [--csv replicas.csv]\n"
+                     "                        [--json summary.json]\n";
+        return 1;
+    }
+    Profiler::enabled.store(false); // Thousands of replicas would only flood the zone rings
+
+    std::shared_ptr<const GridTopology> topology = std::make_shared<GridTopology>(
+        options.zones == 0 ? GridTopology::makeDefault() : GridTopology::makeSynthetic(options.zones, options.seed));
+    std::shared_ptr<ShedPolicy> shedPolicy;
+    if (!options.shedPolicy.rule.empty()) {
+        std::string error;
+        shedPolicy = std::make_shared<ShedPolicy>();
+        if (!shedPolicy->compile(options.shedPolicy, error)) {
+            std::cerr << "ERROR::MONTECARLO::POLICY_COMPILE_FAILED " << error << "\n";
+            return 1;
+        }
+    }
+    if (!options.loadProfile.empty() && options.loadProfile != "curves") {
+        LoadProfile probe; // Fail here rather than in every replica
+        if (!probe.openCsv(options.loadProfile, *topology, options.profileSpeed)) {
+            return 1;
+        }
+    }
+    std::vector<SimulationParams> policies = MakePolicies(options, shedPolicy);
+    CheckpointReader checkpoint; // Mapped once, restored by every replica
+    if (!options.resume.empty()) {
+        Simulation probe(topology, options.seed, policies[0]);
+        if (!checkpoint.openFile(options.resume) || !probe.restoreCheckpoint(checkpoint)) {
+            return 1;
+        }
+    }
+    const uint64_t steps = static_cast<uint64_t>(options.duration / options.dt + 0.5);
+    const size_t total = policies.size() * options.replicas;
+
+    unsigned threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    printf("%zu policies x %d replicas, %llu steps of %.4f s on %zu zones, %u threads\n", policies.size(),
+           options.replicas, (unsigned long long)steps, options.dt, topology->zoneCount(), threads);
+    fflush(stdout);
+
+    // One task per replica; each writes only its own result slot
+    std::vector<ReplicaResult> results(total);
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkerPool pool(threads);
+        for (size_t r = 0; r < total; ++r) {
+            pool.submit([&, r]() {
+                uint64_t seed = options.seed + r % options.replicas;
+                Simulation simulation(topology, seed, policies[r / options.replicas]);
+                LoadProfile loadProfile;
+                if (!options.loadProfile.empty()) {
+                    if (options.loadProfile == "curves") {
+                        loadProfile.openCurves(*topology, options.profileSpeed);
+                    } else if (!loadProfile.openCsv(options.loadProfile, *topology, options.profileSpeed)) {
+                        return; // Checked up front, so only if the file changed under us
+                    }
+                    simulation.setLoadProfile(&loadProfile);
+                }
+                SimulationStats base;
+                if (!options.resume.empty()) {
+                    simulation.restoreCheckpoint(checkpoint); // Checked up front
+                    simulation.reseed(seed);
+                    base = simulation.stats();
+                }
+                for (uint64_t s = 0; s < steps; ++s) {
+                    simulation.step(options.dt);
+                }
+                results[r].seed = seed;
+                results[r].stats = StatsSince(simulation.stats(), base);
+            });
+        }
+        pool.waitIdle();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // --- Summaries ---
+    std::vector<PolicySummary> summaries(policies.size());
+    std::vector<double> samples(options.replicas);
+    printf("%9s %8s %9s %8s", "interval", "auto-cut", "power-cut", "cooldown");
+    for (const MetricField& field : metricFields) {
+        printf(" %29s", (std::string(field.label) + " p10/p50/p90").c_str());
+    }
+    printf(" %9s %11s\n", "auto cuts", "policy cuts");
+    for (size_t p = 0; p < policies.size(); ++p) {
+        PolicySummary& summary = summaries[p];
+        summary.params = policies[p];
+        const ReplicaResult* replicas = &results[p * options.replicas];
+        for (int m = 0; m < metricCount; ++m) {
+            for (int r = 0; r < options.replicas; ++r) {
+                samples[r] = metricFields[m].value(replicas[r].stats);
+            }
+            summary.metrics[m] = Summarize(samples);
+        }
+        for (int r = 0; r < options.replicas; ++r) {
+            summary.automaticCuts += static_cast<double>(replicas[r].stats.automaticCuts) / options.replicas;
+            summary.overloadEvents += static_cast<double>(replicas[r].stats.overloadEvents) / options.replicas;
+            summary.policyCuts += static_cast<double>(replicas[r].stats.policyCuts) / options.replicas;
+        }
+
+        printf("%9.1f %8.1f %9.1f %8.1f", summary.params.overloadInterval, summary.params.autoCutTimeout,
+               summary.params.powerCutDuration, summary.params.cooldownDuration);
+        for (const Distribution& d : summary.metrics) {
+            printf(" %9.1f/%9.1f/%9.1f", d.p10, d.p50, d.p90);
+        }
+        printf(" %9.1f %11.1f\n", summary.automaticCuts, summary.policyCuts);
+    }
+    printf("%zu replicas in %.2f s (%.1f replicas/s, %.2f M zone-steps/s)\n", total, seconds, total / seconds,
+           total * static_cast<double>(steps) * topology->zoneCount() / seconds / 1e6);
+
+    if (!options.csv.empty()) {
+        if (!WriteCsv(options.csv, policies, results, options.replicas)) {
+            std::cerr << "ERROR::MONTECARLO::WRITE_FAILED " << options.csv << "\n";
+            return -1;
+        }
+        printf("Wrote replicas to %s\n", options.csv.c_str());
+    }
+    if (!options.json.empty()) {
+        if (!WriteJson(options.json, options, topology->zoneCount(), summaries)) {
+            std::cerr << "ERROR::MONTECARLO::WRITE_FAILED " << options.json << "\n";
+            return -1;
+        }
+        printf("Wrote summary to %s\n", options.json.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free multi-producer / single-consumer queue (D. Vyukov's
+// bounded queue with per-slot sequence numbers, single-consumer side).
+// Any thread may push(); one thread pop()s. Producers claim a slot with one
+// compare-exchange on the tail and publish it through the slot's sequence
+// number, so a producer never waits for the consumer or for another producer
+// to finish copying. push() fails instead of blocking when the queue is full.
+// Capacity is rounded up to a power of two; T must be default-constructible
+// and copy-assignable.
+template <typename T>
+class MpscQueue
+{
+public:
+    explicit MpscQueue(size_t capacity)
+        : mask(RoundUp(capacity) - 1), slots(new Slot[mask + 1]), tail(0), head(0)
+    {
+        for (size_t i = 0; i <= mask; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Producer side (any thread). False if the queue is full.
+    bool push(const T& value)
+    {
+        size_t position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                // Slot is free for this lap: claim it
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false; // The consumer has not freed it yet
+            } else {
+                position = tail.load(std::memory_order_relaxed); // Another producer took it
+            }
+        }
+    }
+
+    // Consumer side (one thread). False if nothing is ready.
+    bool pop(T& value)
+    {
+        Slot& slot = slots[head & mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != head + 1) {
+            return false; // Empty, or the producer that claimed it is still copying
+        }
+        value = slot.value;
+        slot.sequence.store(head + mask + 1, std::memory_order_release); // Free for the next lap
+        ++head;
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t RoundUp(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> tail; // Next slot to claim (producers)
+    alignas(64) size_t head;              // Next slot to read (consumer only)
+};
+
+#endif // MPSC_QUEUE_H
@@ -0,0 +1,211 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+// Events retained per thread: ~16 s of a 1 kHz simulation thread
+static const uint64_t RING_CAPACITY = 16384;
+
+// One ring entry. Readers copy slots while the owner overwrites them, so the
+// fields are relaxed atomics and collectRing() validates the copy against the
+// head afterwards, seqlock style
+struct ProfileSlot {
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> start;
+    std::atomic<uint64_t> end;
+    std::atomic<uint32_t> depth;
+
+    void store(const ProfileEvent& event)
+    {
+        name.store(event.name, std::memory_order_relaxed);
+        start.store(event.start, std::memory_order_relaxed);
+        end.store(event.end, std::memory_order_relaxed);
+        depth.store(event.depth, std::memory_order_relaxed);
+    }
+
+    ProfileEvent load() const
+    {
+        return { name.load(std::memory_order_relaxed), start.load(std::memory_order_relaxed),
+                 end.load(std::memory_order_relaxed), depth.load(std::memory_order_relaxed) };
+    }
+};
+
+struct ProfileRing {
+    std::string name;
+    ProfileSlot events[RING_CAPACITY];
+    std::atomic<uint64_t> head{0}; // Total events ever written; slot = index % RING_CAPACITY
+
+    void write(const ProfileEvent& event)
+    {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        // A reader that sees any of the stores below also sees head >= index,
+        // so it knows the slot's previous event may be torn
+        std::atomic_thread_fence(std::memory_order_release);
+        events[index % RING_CAPACITY].store(event);
+        head.store(index + 1, std::memory_order_release);
+    }
+};
+
+std::atomic<bool> Profiler::enabled(true);
+
+static std::mutex registryMutex; // Guards ring registration and names
+static std::vector<std::unique_ptr<ProfileRing>> rings;
+static ProfileRing gpuRing;
+static thread_local ProfileRing* threadRing = nullptr;
+
+static std::atomic<uint64_t> previousFrameStart(0);
+static std::atomic<uint64_t> currentFrameStart(0);
+
+static ProfileRing& localRing()
+{
+    if (!threadRing) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        rings.push_back(std::unique_ptr<ProfileRing>(new ProfileRing()));
+        threadRing = rings.back().get();
+        threadRing->name = "Thread " + std::to_string(rings.size());
+    }
+    return *threadRing;
+}
+
+uint64_t Profiler::now()
+{
+    // steady_clock rather than raw rdtsc: portable, no calibration, ~20 ns per call
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t& Profiler::threadDepth()
+{
+    static thread_local uint32_t depth = 0;
+    return depth;
+}
+
+void Profiler::setThreadName(const char* name)
+{
+    ProfileRing& ring = localRing();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ring.name = name;
+}
+
+void Profiler::push(const char* name, uint64_t start, uint64_t end, uint32_t depth)
+{
+    localRing().write({name, start, end, depth});
+}
+
+void Profiler::markFrame()
+{
+    previousFrameStart.store(currentFrameStart.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    currentFrameStart.store(now(), std::memory_order_relaxed);
+}
+
+bool Profiler::lastFrame(uint64_t& start, uint64_t& end)
+{
+    start = previousFrameStart.load(std::memory_order_relaxed);
+    end = currentFrameStart.load(std::memory_order_relaxed);
+    return start != 0 && end > start;
+}
+
+void Profiler::recordGpuZone(const char* name, uint64_t cpuStart, uint64_t durationNs)
+{
+    if (enabled.load(std::memory_order_relaxed)) {
+        gpuRing.write({name, cpuStart, cpuStart + durationNs, 0});
+    }
+}
+
+// Copy the overlapping events of one ring. The owner keeps writing meanwhile,
+// so anything that may have been overwritten during the copy is dropped.
+static void collectRing(ProfileRing& ring, uint64_t from, uint64_t to, std::vector<ProfileEvent>& out)
+{
+    out.clear();
+    uint64_t headBefore = ring.head.load(std::memory_order_acquire);
+    uint64_t first = headBefore > RING_CAPACITY ? headBefore - RING_CAPACITY : 0;
+
+    std::vector<uint64_t> indices;
+    for (uint64_t i = first; i < headBefore; ++i) {
+        ProfileEvent event = ring.events[i % RING_CAPACITY].load();
+        if (to == 0 || (event.end >= from && event.start <= to)) {
+            out.push_back(event);
+            indices.push_back(i);
+        }
+    }
+
+    // The fence keeps the slot reads above from moving past the head reload,
+    // and pairs with the one in write(): any slot the owner had started to
+    // overwrite shows up in headAfter. The owner may be mid-way through
+    // writing index headAfter, whose slot still holds index
+    // headAfter - RING_CAPACITY: that one is dropped too
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t headAfter = ring.head.load(std::memory_order_relaxed);
+    uint64_t oldestValid = headAfter >= RING_CAPACITY ? headAfter - RING_CAPACITY + 1 : 0;
+    size_t keep = 0;
+    for (size_t k = 0; k < out.size(); ++k) {
+        if (indices[k] >= oldestValid) {
+            out[keep++] = out[k];
+        }
+    }
+    out.resize(keep);
+}
+
+void Profiler::collect(uint64_t from, uint64_t to, std::vector<ProfileLane>& lanes)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    lanes.resize(rings.size() + 1);
+    for (size_t i = 0; i < rings.size(); ++i) {
+        lanes[i].name = rings[i]->name;
+        collectRing(*rings[i], from, to, lanes[i].events);
+    }
+    lanes.back().name = "GPU";
+    collectRing(gpuRing, from, to, lanes.back().events);
+}
+
+static void writeJsonString(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool Profiler::exportChromeTrace(const std::string& path)
+{
+    std::vector<ProfileLane> lanes;
+    collect(0, 0, lanes);
+
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    uint64_t origin = UINT64_MAX;
+    for (const ProfileLane& lane : lanes) {
+        for (const ProfileEvent& event : lane.events) {
+            origin = std::min(origin, event.start);
+        }
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (size_t tid = 0; tid < lanes.size(); ++tid) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":", first ? "" : ",\n", tid);
+        writeJsonString(file, lanes[tid].name.c_str());
+        fprintf(file, "}}");
+        first = false;
+
+        for (const ProfileEvent& event : lanes[tid].events) {
+            fprintf(file, ",\n{\"name\":");
+            writeJsonString(file, event.name);
+            // Chrome trace timestamps are microseconds
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                    tid, (event.start - origin) / 1000.0, (event.end - event.start) / 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Low-overhead scoped CPU profiler.
+// PROFILE_SCOPE("name") records a begin/end pair (steady_clock nanoseconds)
+// into a fixed ring buffer owned by the calling thread: no locks and no
+// allocation on the hot path. The UI and the Chrome trace exporter read the
+// rings concurrently and drop any event that was overwritten mid-copy.
+// Names must be string literals (only the pointer is stored).
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t start; // ns, Profiler::now() clock
+    uint64_t end;
+    uint32_t depth; // Nesting level within the thread
+};
+
+// Events of one thread (or the GPU lane) copied out for display/export
+struct ProfileLane {
+    std::string name;
+    std::vector<ProfileEvent> events;
+};
+
+class Profiler
+{
+public:
+    static uint64_t now();
+
+    // Label the calling thread in the timeline ("Render", "Simulation", ...)
+    static void setThreadName(const char* name);
+
+    // Frame boundary on the render thread; the UI shows the last complete frame
+    static void markFrame();
+    static bool lastFrame(uint64_t& start, uint64_t& end);
+
+    // GPU zones measured elsewhere (GpuTimerPool) end up in their own lane
+    static void recordGpuZone(const char* name, uint64_t cpuStart, uint64_t durationNs);
+
+    // Copy every event overlapping [from, to] (all retained events if to == 0)
+    static void collect(uint64_t from, uint64_t to, std::vector<ProfileLane>& lanes);
+
+    // Everything still in the rings, as a chrome://tracing / Perfetto JSON file
+    static bool exportChromeTrace(const std::string& path);
+
+    static std::atomic<bool> enabled;
+
+    // Used by ProfileScope
+    static void push(const char* name, uint64_t start, uint64_t end, uint32_t depth);
+    static uint32_t& threadDepth();
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+        : name(name), start(Profiler::now()), depth(Profiler::threadDepth()++)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        --Profiler::threadDepth();
+        if (Profiler::enabled.load(std::memory_order_relaxed)) {
+            Profiler::push(name, start, Profiler::now(), depth);
+        }
+    }
+
+private:
+    const char* name;
+    uint64_t start;
+    uint32_t depth;
+};
+
+#ifndef PGLMS_DISABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,105 @@
+#include "profiler_window.h"
+#include <cstdio>
+#include <vector>
+#include "imgui.h"
+#include "gpu_timer.h"
+#include "profiler.h"
+
+// Stable color per zone name so the same zone looks the same every frame
+static ImU32 zoneColor(const char* name)
+{
+    unsigned hash = 2166136261u;
+    for (const char* c = name; *c; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+    }
+    float hue = (hash % 360) / 360.0f;
+    float r, g, b;
+    ImGui::ColorConvertHSVtoRGB(hue, 0.55f, 0.85f, r, g, b);
+    return ImGui::GetColorU32(ImVec4(r, g, b, 1.0f));
+}
+
+void DrawProfilerWindow(GpuTimerPool* gpuTimers, bool* open)
+{
+    static std::vector<ProfileLane> lanes;
+    static bool paused = false;
+    static uint64_t frameStart = 0, frameEnd = 0;
+    static char exportStatus[128] = "";
+
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Checkbox("Pause", &paused);
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome Trace")) {
+        const char* path = "profile_trace.json";
+        snprintf(exportStatus, sizeof(exportStatus), Profiler::exportChromeTrace(path)
+                 ? "Wrote %s (open in chrome://tracing or ui.perfetto.dev)" : "Failed to write %s", path);
+    }
+    if (exportStatus[0]) {
+        ImGui::TextDisabled("%s", exportStatus);
+    }
+
+    if (!paused && Profiler::lastFrame(frameStart, frameEnd)) {
+        Profiler::collect(frameStart, frameEnd, lanes);
+    }
+    if (frameEnd <= frameStart) {
+        ImGui::End();
+        return;
+    }
+    double frameMs = (frameEnd - frameStart) / 1.0e6;
+    ImGui::Text("Frame %.3f ms", frameMs);
+
+    if (gpuTimers) {
+        for (const GpuTimerPool::Result& result : gpuTimers->results()) {
+            ImGui::BulletText("GPU %s: %.3f ms", result.name, result.milliseconds);
+        }
+    }
+    ImGui::Separator();
+
+    // --- Flame graph: one lane per thread, one row per nesting level ---
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const float width = ImGui::GetContentRegionAvail().x;
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    for (const ProfileLane& lane : lanes) {
+        if (lane.events.empty()) {
+            continue;
+        }
+        uint32_t maxDepth = 0;
+        for (const ProfileEvent& event : lane.events) {
+            maxDepth = event.depth > maxDepth ? event.depth : maxDepth;
+        }
+
+        ImGui::TextUnformatted(lane.name.c_str());
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float laneHeight = rowHeight * (maxDepth + 1);
+        ImGui::Dummy(ImVec2(width, laneHeight));
+        drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + laneHeight), IM_COL32(30, 30, 30, 255));
+
+        for (const ProfileEvent& event : lane.events) {
+            // Clip to the frame window
+            double start = event.start < frameStart ? 0.0 : (event.start - frameStart) / 1.0e6;
+            double end = event.end > frameEnd ? frameMs : (event.end - frameStart) / 1.0e6;
+            float x0 = origin.x + static_cast<float>(start / frameMs) * width;
+            float x1 = origin.x + static_cast<float>(end / frameMs) * width;
+            if (x1 - x0 < 1.0f) {
+                x1 = x0 + 1.0f;
+            }
+            float y0 = origin.y + event.depth * rowHeight;
+            ImVec2 min(x0, y0), max(x1, y0 + rowHeight - 1.0f);
+            drawList->AddRectFilled(min, max, zoneColor(event.name));
+
+            if (x1 - x0 > ImGui::CalcTextSize(event.name).x + 4.0f) {
+                drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), event.name);
+            }
+            if (ImGui::IsMouseHoveringRect(min, max) && mouse.x >= x0 && mouse.x <= x1) {
+                ImGui::SetTooltip("%s\n%.3f ms", event.name, (event.end - event.start) / 1.0e6);
+            }
+        }
+    }
+
+    ImGui::End();
+}
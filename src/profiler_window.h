@@ -0,0 +1,10 @@
+#ifndef PROFILER_WINDOW_H
+#define PROFILER_WINDOW_H
+
+class GpuTimerPool;
+
+// ImGui "Profiler" window: per-thread flame graph of the last complete frame,
+// GPU pass timings and Chrome trace export.
+void DrawProfilerWindow(GpuTimerPool* gpuTimers, bool* open);
+
+#endif // PROFILER_WINDOW_H
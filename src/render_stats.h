@@ -0,0 +1,35 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <cstdint>
+#include <glad/glad.h>
+
+// Per-frame draw submission counters (render thread only).
+// Reset at the start of a frame, read by the benchmark and debug UI.
+struct RenderStats {
+    uint64_t drawCalls = 0;
+    uint64_t triangles = 0;
+
+    void reset() { drawCalls = 0; triangles = 0; }
+
+    // Account one draw of `count` vertices/indices in `mode`
+    void record(GLenum mode, uint64_t count, uint64_t instances = 1)
+    {
+        ++drawCalls;
+        addPrimitives(mode, count, instances);
+    }
+
+    // Triangles of one sub-draw of a multi-draw (already counted as a call)
+    void addPrimitives(GLenum mode, uint64_t count, uint64_t instances = 1)
+    {
+        if (mode == GL_TRIANGLES) {
+            triangles += count / 3 * instances;
+        } else if (mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) {
+            triangles += (count >= 3 ? count - 2 : 0) * instances;
+        }
+    }
+};
+
+RenderStats& FrameRenderStats();
+
+#endif // RENDER_STATS_H
@@ -0,0 +1,100 @@
+#include "render_target.h"
+#include <cstring>
+#include <iostream>
+
+// --- RenderTarget ---
+
+RenderTarget::RenderTarget(int width, int height)
+    : w(width), h(height)
+{
+    colorBuffer = GlRenderbuffer::create();
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    FBO = GlFramebuffer::create();
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO.get());
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer.get());
+}
+
+void RenderTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO.get());
+    glViewport(0, 0, w, h);
+}
+
+// --- PixelReadback ---
+
+PixelReadback::PixelReadback(int width, int height, int ringSize)
+    : w(width), h(height), slots(ringSize), head(0), pendingCount(0)
+{
+    for (Slot& slot : slots) {
+        slot.PBO = GlBuffer::create();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO.get());
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes(), nullptr, GL_STREAM_READ);
+        slot.fence = nullptr;
+        slot.frameId = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void PixelReadback::capture(uint64_t frameId)
+{
+    Slot& slot = slots[head];
+    slot.frameId = frameId;
+
+    // With a PACK buffer bound, glReadPixels writes into it and returns immediately
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO.get());
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    head = (head + 1) % static_cast<int>(slots.size());
+    ++pendingCount;
+}
+
+ReadbackStatus PixelReadback::collect(std::vector<uint8_t>& pixels, uint64_t& frameId, bool wait)
+{
+    if (pendingCount == 0) {
+        return ReadbackStatus::NotReady;
+    }
+    int ringSize = static_cast<int>(slots.size());
+    Slot& slot = slots[(head - pendingCount + ringSize) % ringSize];
+
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return ReadbackStatus::NotReady;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    frameId = slot.frameId;
+    --pendingCount;
+    if (status == GL_WAIT_FAILED) {
+        std::cerr << "ERROR::READBACK::WAIT_FAILED frame " << frameId << "\n";
+        return ReadbackStatus::Lost;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO.get());
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes(), GL_MAP_READ_BIT);
+    if (mapped) {
+        pixels.resize(frameBytes());
+        memcpy(pixels.data(), mapped, frameBytes());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        std::cerr << "ERROR::READBACK::MAP_FAILED frame " << frameId << "\n";
+        return ReadbackStatus::Lost;
+    }
+    return ReadbackStatus::Ready;
+}
+
+PixelReadback::~PixelReadback()
+{
+    for (Slot& slot : slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "gl_resource.h"
+
+// Offscreen color target (RGBA8 renderbuffer behind an FBO).
+// Used instead of the window's default framebuffer for headless rendering.
+class RenderTarget
+{
+public:
+    RenderTarget(int width, int height);
+
+    // Bind as draw + read framebuffer and set the viewport to cover it
+    void bind();
+
+    int width() const { return w; }
+    int height() const { return h; }
+    GLuint framebuffer() const { return FBO.get(); }
+
+private:
+    int w, h;
+    GlFramebuffer FBO;
+    GlRenderbuffer colorBuffer;
+};
+
+enum class ReadbackStatus {
+    NotReady, // Nothing pending, or (when !wait) the GPU is not done yet
+    Ready,    // `pixels` holds the frame
+    Lost      // The fence or the mapping failed; the slot is freed and `pixels` left as is
+};
+
+// Asynchronous pixel readback through a ring of pixel-pack buffers.
+// capture() only queues a glReadPixels into the next PBO (no CPU stall);
+// collect() maps the oldest one once its fence has signaled, which is
+// normally a couple of frames later.
+class PixelReadback
+{
+public:
+    PixelReadback(int width, int height, int ringSize = 3);
+    ~PixelReadback();
+
+    bool full() const { return pendingCount == static_cast<int>(slots.size()); }
+    bool empty() const { return pendingCount == 0; }
+
+    // Queue a copy of the currently bound read framebuffer. Requires !full().
+    void capture(uint64_t frameId);
+
+    // Fetch the oldest capture as tightly packed, bottom-up RGBA8 rows.
+    // `frameId` is set for Ready and Lost, so callers can account for every frame.
+    ReadbackStatus collect(std::vector<uint8_t>& pixels, uint64_t& frameId, bool wait);
+
+    size_t frameBytes() const { return static_cast<size_t>(w) * h * 4; }
+
+private:
+    struct Slot {
+        GlBuffer PBO;
+        GLsync fence;
+        uint64_t frameId;
+    };
+
+    int w, h;
+    std::vector<Slot> slots;
+    int head;         // Next slot to capture into
+    int pendingCount; // Captures not yet collected; the oldest is at head - pendingCount
+};
+
+#endif // RENDER_TARGET_H
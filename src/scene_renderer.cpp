@@ -0,0 +1,152 @@
+#include "scene_renderer.h"
+#include "alloc_tracker.h"
+#include "gl_features.h"
+
+// --- Define vertices and indices for the static meshes ---
+
+// Every mesh is flat, so positions go to the GPU as two snorm16 values
+// (4 bytes instead of 12); indices are narrowed to bytes/shorts on upload
+static const VertexLayout meshLayout = { PositionFormat::Snorm16x2, false };
+
+static const std::vector<float> sourceVertices = {
+    -0.5f, 0.0f, 0.0f,
+    0.5f, 0.0f, 0.0f,
+    0.3f, 0.3f, 0.0f,
+    0.2f, 0.6f, 0.0f,
+    0.2f, 1.0f, 0.0f,
+    -0.2f, 1.0f, 0.0f,
+    -0.2f, 0.6f, 0.0f,
+    -0.3f, 0.3f, 0.0f,
+};
+static const std::vector<GLuint> sourceIndices =
+  { 0, 1, 2,
+    2, 7, 0,
+    7, 2, 3,
+    3, 6, 7,
+    6, 3, 4,
+    4, 5, 6 };
+
+static const std::vector<float> transmissionVertices = {
+    0.0f, 0.0f, 0.0f,
+    0.25f, 0.0f, 0.0f,
+    0.125f, 0.75f, 0.0f,
+    0.0f, 1.5f, 0.0f,
+    -0.125f, 0.75f, 0.0f,
+    -0.25f, 0.0f, 0.0f,
+    0.0f, 0.2f, 0.0f
+};
+static const std::vector<GLuint> transmissionIndices =
+  { 5, 4, 3,
+    5, 3, 2,
+    5, 2, 6,
+    6, 2, 1 };
+
+// Wires: generator to every transmitter top, every transmitter top to its houses
+// (hairline capsules; static, so uploaded once)
+static void buildWires(const GridTopology& topology, SdfBatch& batch)
+{
+    const glm::vec3 wireColor(0.0f, 0.0f, 0.0f);
+    for (const glm::vec3& top : topology.transmitterTops) {
+        batch.capsule(glm::vec2(topology.generatorPos), glm::vec2(top), 0.0f, wireColor);
+    }
+    for (size_t i = 0; i < topology.zoneCount(); ++i) {
+        batch.capsule(glm::vec2(topology.transmitterTops[topology.zoneFeeder[i]]), glm::vec2(topology.zonePositions[i]), 0.0f, wireColor);
+    }
+    batch.upload();
+}
+
+// House color for each state, indexed by HouseState
+static const glm::vec3 zoneStateColors[] = {
+    glm::vec3(0.0f, 1.0f, 0.0f), // NORMAL: Green
+    glm::vec3(1.0f, 1.0f, 0.0f), // WARNING: Yellow
+    glm::vec3(1.0f, 0.0f, 0.0f), // OVERLOADED: Red
+    glm::vec3(0.2f, 0.2f, 0.2f), // POWER_CUT: Dark Gray
+    glm::vec3(0.5f, 0.5f, 0.5f), // COOLDOWN: Gray (during cooldown)
+};
+
+glm::vec3 ZoneStateColor(HouseState state)
+{
+    return state < sizeof(zoneStateColors) / sizeof(zoneStateColors[0]) ? zoneStateColors[state] : glm::vec3(1.0f);
+}
+
+SceneRenderer::SceneRenderer(const GridTopology& topology)
+    : heatmapMode(false),
+      multiDraw(GlSupport().multiDrawIndirect),
+      heatmap(240, 135), // Quarter of the default window resolution
+      topology(topology),
+      instancedShader("Shaders/instanced.vs", "Shaders/instanced.fs"),
+      sdfShader("Shaders/sdf.vs", "Shaders/sdf.fs"),
+      meshes(meshLayout),
+      circleSize(0.05f),
+      frameArena(topology.zoneCount() * sizeof(HeatPoint) + 4096) // Room for one heat point per zone
+{
+    generatorMesh = meshes.add(sourceVertices, sourceIndices);
+    transmitterMesh = meshes.add(transmissionVertices, transmissionIndices);
+    meshes.upload();
+
+    buildWires(topology, wires);
+}
+
+void SceneRenderer::draw(const SimSnapshot& snapshot)
+{
+    ALLOC_SCOPE(AllocTag::Render);
+
+    // Wires go first: everything else is drawn on top of them
+    wires.draw(sdfShader);
+
+    // --- Generator and transmitters: one multi-draw ---
+    meshes.beginFrame();
+    meshes.beginCommand(generatorMesh);
+    meshes.addInstance(glm::vec2(topology.generatorPos), 0.3f, glm::vec3(0.5f, 0.5f, 0.5f));
+    meshes.beginCommand(transmitterMesh);
+    for (const glm::vec3& position : topology.transmitterPositions) {
+        meshes.addInstance(glm::vec2(position), topology.markerScale, glm::vec3(0.36f, 0.25f, 0.20f));
+    }
+    instancedShader.use();
+    meshes.draw(multiDraw);
+
+    // --- Flow circles, then houses (SDF quads) ---
+    shapes.clear();
+    const glm::vec3 circleColor(1.0f, 1.0f, 0.0f); // Yellow
+    const float circleRadius = 0.5f * circleSize;
+    for (const FlowPath& flow : topology.flows) {
+        // Hide the circle if its target house is in power cut
+        if (flow.targetHouseIndex != -1 && snapshot.state[flow.targetHouseIndex] == POWER_CUT) {
+            continue;
+        }
+        shapes.circle(glm::vec2(flow.positionAt(snapshot.time)), circleRadius, circleColor);
+    }
+    // Overload circles are slightly larger
+    for (const FlowPath& flow : snapshot.overloadFlows) {
+        shapes.circle(glm::vec2(flow.positionAt(snapshot.time)), circleRadius * 1.5f, circleColor);
+    }
+
+    // Houses are markerScale wide by markerScale * 0.5 high, standing on the zone position;
+    // their colors follow the zone state
+    const glm::vec2 houseHalfSize(0.5f * topology.markerScale, 0.25f * topology.markerScale);
+    const float houseCorner = 0.05f * topology.markerScale;
+    for (size_t i = 0; i < topology.zoneCount(); ++i) {
+        glm::vec3 color = heatmapMode ? glm::vec3(0.8f, 0.8f, 0.8f) // Neutral, the heatmap carries the load
+                                      : ZoneStateColor(snapshot.state[i]);
+        glm::vec2 center = glm::vec2(topology.zonePositions[i]) + glm::vec2(0.0f, houseHalfSize.y);
+        shapes.roundedRect(center, houseHalfSize, houseCorner, color);
+    }
+    shapes.upload();
+    shapes.draw(sdfShader);
+
+    // --- Heatmap overlay: one splat pass + one full-screen resolve pass ---
+    if (heatmapMode) {
+        std::pmr::vector<HeatPoint> heatPoints(&frameArena);
+        heatPoints.reserve(topology.zoneCount());
+        for (size_t i = 0; i < topology.zoneCount(); ++i) {
+            // Overloaded houses are pinned to the top of the ramp regardless of their load curve
+            float weight = snapshot.state[i] == OVERLOADED ? 1.0f : snapshot.currentLoad[i] / topology.maxLoad[i];
+            glm::vec3 center = topology.zonePositions[i] + glm::vec3(0.0f, 0.25f * topology.markerScale, 0.0f); // Middle of the house rectangle
+            heatPoints.push_back({glm::vec2(center), weight});
+        }
+        heatmap.splat(heatPoints.data(), heatPoints.size(), 1.25f * topology.markerScale); // 0.25 on the demo grid
+        heatmap.draw();
+    }
+
+    frameArena.reset();
+}
@@ -0,0 +1,46 @@
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+
+#include <glm/glm.hpp>
+#include "frame_arena.h"
+#include "shader.h"
+#include "heatmap.h"
+#include "mesh_registry.h"
+#include "sdf_batch.h"
+#include "simulation.h"
+
+// Draws the grid for a simulation snapshot.
+// Wires, flow circles and houses are SDF quads (SdfBatch; the wires are
+// static and uploaded once). Generator and transmitters are polygon meshes in
+// a MeshRegistry, drawn with one multi-draw indirect call (or one instanced
+// draw per mesh on GL 3.3).
+class SceneRenderer
+{
+public:
+    explicit SceneRenderer(const GridTopology& topology);
+
+    void draw(const SimSnapshot& snapshot);
+
+    bool heatmapMode; // Show zone loads as a heatmap instead of per-house colors
+    bool multiDraw;   // Use glMultiDrawElementsIndirect when supported (defaults to GlSupport())
+    Heatmap heatmap;
+
+private:
+    const GridTopology& topology;
+    Shader instancedShader; // Registry meshes
+    Shader sdfShader;       // SDF batches
+
+    MeshRegistry meshes;
+    MeshId generatorMesh;
+    MeshId transmitterMesh;
+    SdfBatch wires;  // Static
+    SdfBatch shapes; // Flow circles and houses, refilled every frame
+
+    float circleSize;
+    FrameArena frameArena; // Per-frame scratch (heat points), reset at the end of draw()
+};
+
+// House color for each state
+glm::vec3 ZoneStateColor(HouseState state);
+
+#endif // SCENE_RENDERER_H
@@ -0,0 +1,105 @@
+#include "sdf_batch.h"
+#include "render_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Unit quad as a triangle strip; the vertex shader places it per shape
+static const float quadCorners[] = {
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+    -1.0f,  1.0f,
+     1.0f,  1.0f,
+};
+
+SdfBatch::SdfBatch()
+    : uploaded(0), capacity(0)
+{
+    VAO = GlVertexArray::create();
+    quadBuffer = GlBuffer::create();
+    instanceBuffer = GlBuffer::create();
+
+    glBindVertexArray(VAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer.get());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadCorners), quadCorners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SdfInstance), (void*)offsetof(SdfInstance, geometry));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(SdfInstance), (void*)offsetof(SdfInstance, radius));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SdfInstance), (void*)offsetof(SdfInstance, color));
+    for (GLuint attribute = 1; attribute <= 3; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+}
+
+void SdfBatch::clear()
+{
+    instances.clear();
+}
+
+void SdfBatch::add(const glm::vec4& geometry, float radius, float shape, glm::vec3 color)
+{
+    SdfInstance instance;
+    instance.geometry = geometry;
+    instance.radius = radius;
+    instance.shape = shape;
+    for (int c = 0; c < 3; ++c) {
+        instance.color[c] = static_cast<uint8_t>(std::lround(std::clamp(color[c], 0.0f, 1.0f) * 255.0f));
+    }
+    instance.color[3] = 255;
+    instances.push_back(instance);
+}
+
+void SdfBatch::circle(glm::vec2 center, float radius, glm::vec3 color)
+{
+    add(glm::vec4(center, center), radius, 0.0f, color); // A capsule with a zero-length segment
+}
+
+void SdfBatch::capsule(glm::vec2 a, glm::vec2 b, float radius, glm::vec3 color)
+{
+    add(glm::vec4(a, b), radius, 0.0f, color);
+}
+
+void SdfBatch::roundedRect(glm::vec2 center, glm::vec2 halfSize, float cornerRadius, glm::vec3 color)
+{
+    add(glm::vec4(center, halfSize), cornerRadius, 1.0f, color);
+}
+
+void SdfBatch::upload()
+{
+    uploaded = instances.size();
+    if (uploaded == 0) {
+        return;
+    }
+    // Orphan and refill (grown by doubling, never shrunk)
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    if (uploaded > capacity) {
+        capacity = std::max(uploaded, capacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(SdfInstance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, uploaded * sizeof(SdfInstance), instances.data());
+}
+
+void SdfBatch::draw(Shader& shader)
+{
+    if (uploaded == 0) {
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    shader.use();
+    shader.setVec2("uPixelSize", glm::vec2(2.0f / std::max(viewport[2], 1), 2.0f / std::max(viewport[3], 1)));
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindVertexArray(VAO.get());
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(uploaded));
+    FrameRenderStats().record(GL_TRIANGLE_STRIP, 4, uploaded);
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+}
@@ -0,0 +1,55 @@
+#ifndef SDF_BATCH_H
+#define SDF_BATCH_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "gl_resource.h"
+#include "shader.h"
+
+// Analytic shapes drawn as one instanced quad each (2 triangles).
+// The fragment shader (Shaders/sdf.fs) evaluates the shape's signed distance
+// and turns it into about one pixel of anti-aliased edge, so circles,
+// capsules and rounded rectangles stay smooth at any size instead of being
+// tessellated. Coordinates and sizes are in NDC like the rest of the scene.
+// Capsules are stretched along their segment so long diagonal ones do not
+// cover a whole bounding box. Shapes are drawn in the order they were added;
+// draw() alpha-blends them over what is already in the framebuffer.
+
+struct SdfInstance {
+    glm::vec4 geometry; // Capsule: endpoints a.xy, b.xy; rounded rect: center.xy, half size.xy
+    float radius;       // Capsule radius or rect corner radius
+    float shape;        // 0 = capsule, 1 = rounded rect (a float keeps it a plain attribute)
+    uint8_t color[4];
+};
+
+class SdfBatch
+{
+public:
+    SdfBatch();
+
+    void clear();
+    void circle(glm::vec2 center, float radius, glm::vec3 color);
+    // Radius 0 draws a one pixel wide line
+    void capsule(glm::vec2 a, glm::vec2 b, float radius, glm::vec3 color);
+    void roundedRect(glm::vec2 center, glm::vec2 halfSize, float cornerRadius, glm::vec3 color);
+    size_t size() const { return instances.size(); }
+
+    // Copy the shapes to the GPU (each frame for dynamic batches, once for static ones)
+    void upload();
+
+    // `shader` is the Shaders/sdf.vs/.fs program; uses the current viewport for the edge width
+    void draw(Shader& shader);
+
+private:
+    GlVertexArray VAO;
+    GlBuffer quadBuffer, instanceBuffer;
+    std::vector<SdfInstance> instances; // Keeps its capacity across clear()
+    size_t uploaded;
+    size_t capacity; // Instances the GPU buffer holds (grown by doubling)
+
+    void add(const glm::vec4& geometry, float radius, float shape, glm::vec3 color);
+};
+
+#endif // SDF_BATCH_H
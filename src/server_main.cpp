@@ -0,0 +1,119 @@
+// Simulation server: runs the simulation at a fixed step rate with no window
+// and serves the control/telemetry protocol in control_server.h on a
+// Unix-domain socket, for SCADA stand-ins and test harnesses.
+//
+//   pglms_server [--socket PATH] [--zones N] [--seed S] [--rate HZ]
+//                [--duration SECONDS] [--no-prompt]
+//                [--load-quantum Q] [--keyframe-interval FRAMES]
+//
+// --zones 0 (the default) serves the four-house demo grid. Forced overloads
+// wait on the operator prompt unless --no-prompt is given; clients answer it
+// with ConfirmCut/DeclineCut commands. Runs until SIGINT/SIGTERM or for
+// --duration seconds, then prints the traffic totals. --load-quantum and
+// --keyframe-interval tune the packed (SubscribePacked) stream.
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "cli_args.h"
+#include "control_server.h"
+#include "profiler.h"
+#include "simulation.h"
+#include "simulation_thread.h"
+
+struct ServerOptions {
+    std::string socket = "/tmp/pglms.sock";
+    size_t zones = 0;
+    uint64_t seed = 1;
+    double rate = 1000.0;
+    double duration = 0.0; // 0: until interrupted
+    bool operatorPrompt = true;
+    SnapshotCodecParams packed;
+};
+
+static bool ParseOptions(int argc, char** argv, ServerOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (arg == "--socket" && hasValue) options.socket = argv[++i];
+        else if (arg == "--zones" && hasValue) valid = ParseNumber(argv[++i], options.zones);
+        else if (arg == "--seed" && hasValue) valid = ParseNumber(argv[++i], options.seed);
+        else if (arg == "--rate" && hasValue) valid = ParseNumber(argv[++i], options.rate);
+        else if (arg == "--duration" && hasValue) valid = ParseNumber(argv[++i], options.duration);
+        else if (arg == "--no-prompt") options.operatorPrompt = false;
+        else if (arg == "--load-quantum" && hasValue) valid = ParseNumber(argv[++i], options.packed.loadQuantum);
+        else if (arg == "--keyframe-interval" && hasValue) valid = ParseNumber(argv[++i], options.packed.keyframeInterval);
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+        if (!valid) {
+            std::cerr << "Bad value for " << arg << ": " << argv[i] << "\n";
+            return false;
+        }
+    }
+    return options.rate > 0.0 && options.duration >= 0.0 && options.packed.loadQuantum > 0.0f;
+}
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void RequestStop(int)
+{
+    stopRequested = 1;
+}
+
+int main(int argc, char** argv)
+{
+    ServerOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "usage: pglms_server [--socket PATH] [--zones N] [--seed S] [--rate HZ]\n"
+                     "                    [--duration SECONDS] [--no-prompt]\n"
+                     "                    [--load-quantum Q] [--keyframe-interval FRAMES]\n";
+        return 1;
+    }
+    Profiler::setThreadName("Main");
+
+    std::shared_ptr<const GridTopology> topology = std::make_shared<GridTopology>(
+        options.zones == 0 ? GridTopology::makeDefault() : GridTopology::makeSynthetic(options.zones, options.seed));
+    SimulationParams params;
+    params.operatorPrompt = options.operatorPrompt;
+    Simulation simulation(topology, options.seed, params);
+
+    ControlServer server(simulation, options.packed);
+    if (!server.start(options.socket)) {
+        return -1;
+    }
+    SimulationThread simulationThread(simulation, options.rate);
+    simulationThread.onPublish = [&server](const Simulation& source) { server.publish(source); };
+    simulationThread.start();
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+    printf("Serving %zu zones on %s at %.0f steps/s\n", topology->zoneCount(), options.socket.c_str(), options.rate);
+    fflush(stdout);
+
+    auto start = std::chrono::steady_clock::now();
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (options.duration > 0.0 && elapsed >= options.duration) {
+            break;
+        }
+    }
+
+    server.stop(); // Clients go first; publish() is harmless once the server has stopped
+    simulationThread.stop();
+    ControlServerStats stats = server.stats();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%llu steps, %llu connections, %llu commands, %llu zone updates (%.0f/s), %.1f MB sent, %llu coalesced ticks\n",
+           (unsigned long long)simulation.stepCount(), (unsigned long long)stats.connections,
+           (unsigned long long)stats.commands, (unsigned long long)stats.zoneUpdates, stats.zoneUpdates / seconds,
+           stats.bytesSent / 1e6, (unsigned long long)stats.coalescedTicks);
+    return 0;
+}
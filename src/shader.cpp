@@ -29,27 +29,35 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     glShaderSource(fragment, 1, &fShaderCode, NULL);
     glCompileShader(fragment);
 
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
+    ID = GlProgram::create();
+    glAttachShader(ID.get(), vertex);
+    glAttachShader(ID.get(), fragment);
+    glLinkProgram(ID.get());
 
     glDeleteShader(vertex);
     glDeleteShader(fragment);
 }
 
 void Shader::use() {
-    glUseProgram(ID);
+    glUseProgram(ID.get());
 }
 
 void Shader::deleteProgram() {
-    glDeleteProgram(ID);
+    ID.reset();
+}
+
+void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
+    glUniform2fv(glGetUniformLocation(ID.get(), name.c_str()), 1, glm::value_ptr(value));
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    glUniform3fv(glGetUniformLocation(ID.get(), name.c_str()), 1, glm::value_ptr(value));
 }
 
 void Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(glGetUniformLocation(ID.get(), name.c_str()), value);
+}
+
+void Shader::setInt(const std::string &name, int value) const {
+    glUniform1i(glGetUniformLocation(ID.get(), name.c_str()), value);
 }
@@ -4,17 +4,20 @@
 #include <string>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include "gl_resource.h"
 
 class Shader {
 public:
-    GLuint ID;
+    GlProgram ID; // Move-only; deleted through GlDeletionQueue with the Shader
 
     Shader(const char* vertexPath, const char* fragmentPath);
     void use();
     void deleteProgram();
 
+    void setVec2(const std::string &name, const glm::vec2 &value) const;
     void setVec3(const std::string &name, const glm::vec3 &value) const;
     void setFloat(const std::string &name, float value) const;
+    void setInt(const std::string &name, int value) const;
 };
 
 #endif
@@ -0,0 +1,397 @@
+#include "shed_policy.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// --- Rule compiler ---
+// Recursive descent over the rule text, emitting postfix bytecode as it goes.
+
+namespace {
+
+struct NamedInput {
+    const char* name;
+    ShedPolicy::Input input;
+};
+
+const NamedInput namedInputs[] = {
+    { "load", ShedPolicy::Input::Load },
+    { "max_load", ShedPolicy::Input::MaxLoad },
+    { "load_ratio", ShedPolicy::Input::LoadRatio },
+    { "priority", ShedPolicy::Input::Priority },
+    { "state", ShedPolicy::Input::State },
+    { "time_in_state", ShedPolicy::Input::TimeInState },
+    { "prompt", ShedPolicy::Input::Prompt },
+    { "rotation", ShedPolicy::Input::Rotation },
+    { "grid_load_ratio", ShedPolicy::Input::GridLoadRatio },
+};
+
+struct NamedConstant {
+    const char* name;
+    float value;
+};
+
+const NamedConstant namedConstants[] = {
+    { "true", 1.0f },
+    { "false", 0.0f },
+    { "NORMAL", static_cast<float>(NORMAL) },
+    { "WARNING", static_cast<float>(WARNING) },
+    { "OVERLOADED", static_cast<float>(OVERLOADED) },
+    { "POWER_CUT", static_cast<float>(POWER_CUT) },
+    { "COOLDOWN", static_cast<float>(COOLDOWN) },
+};
+
+// Binary operators by precedence level, loosest first
+struct BinaryOperator {
+    const char* token;
+    ShedPolicy::Op op;
+};
+
+const BinaryOperator orOperators[] = { { "||", ShedPolicy::Op::Or } };
+const BinaryOperator andOperators[] = { { "&&", ShedPolicy::Op::And } };
+const BinaryOperator compareOperators[] = {
+    { "==", ShedPolicy::Op::Equal }, { "!=", ShedPolicy::Op::NotEqual },
+    { "<=", ShedPolicy::Op::LessEqual }, { ">=", ShedPolicy::Op::GreaterEqual },
+    { "<", ShedPolicy::Op::Less }, { ">", ShedPolicy::Op::Greater },
+};
+const BinaryOperator addOperators[] = { { "+", ShedPolicy::Op::Add }, { "-", ShedPolicy::Op::Subtract } };
+const BinaryOperator multiplyOperators[] = { { "*", ShedPolicy::Op::Multiply }, { "/", ShedPolicy::Op::Divide } };
+
+struct OperatorLevel {
+    const BinaryOperator* operators;
+    size_t count;
+};
+
+const OperatorLevel operatorLevels[] = {
+    { orOperators, sizeof(orOperators) / sizeof(orOperators[0]) },
+    { andOperators, sizeof(andOperators) / sizeof(andOperators[0]) },
+    { compareOperators, sizeof(compareOperators) / sizeof(compareOperators[0]) },
+    { addOperators, sizeof(addOperators) / sizeof(addOperators[0]) },
+    { multiplyOperators, sizeof(multiplyOperators) / sizeof(multiplyOperators[0]) },
+};
+const int levelCount = sizeof(operatorLevels) / sizeof(operatorLevels[0]);
+
+struct RuleParser {
+    const std::string& text;
+    size_t position;
+    std::vector<ShedPolicy::Instruction>& code;
+    std::string error;
+
+    void skipSpace()
+    {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+            ++position;
+        }
+    }
+
+    bool accept(const char* token)
+    {
+        skipSpace();
+        size_t length = std::strlen(token);
+        if (text.compare(position, length, token) != 0) {
+            return false;
+        }
+        // "<" must not swallow the start of "<=", "!" not the start of "!="
+        if (length == 1 && position + 1 < text.size() && text[position + 1] == '=' && std::strchr("<>!=", token[0])) {
+            return false;
+        }
+        position += length;
+        return true;
+    }
+
+    bool fail(const char* message)
+    {
+        if (error.empty()) {
+            error = std::string(message) + " at column " + std::to_string(position + 1);
+        }
+        return false;
+    }
+
+    void emit(ShedPolicy::Op op, ShedPolicy::Input input = ShedPolicy::Input::Load, float constant = 0.0f)
+    {
+        code.push_back({ op, input, false, constant });
+    }
+
+    bool parseLevel(int level)
+    {
+        if (level == levelCount) {
+            return parseUnary();
+        }
+        if (!parseLevel(level + 1)) {
+            return false;
+        }
+        for (;;) {
+            const OperatorLevel& operators = operatorLevels[level];
+            const BinaryOperator* matched = nullptr;
+            for (size_t o = 0; o < operators.count && !matched; ++o) {
+                if (accept(operators.operators[o].token)) {
+                    matched = &operators.operators[o];
+                }
+            }
+            if (!matched) {
+                return true;
+            }
+            if (!parseLevel(level + 1)) {
+                return false;
+            }
+            emit(matched->op);
+        }
+    }
+
+    bool parseUnary()
+    {
+        if (accept("!")) {
+            if (!parseUnary()) {
+                return false;
+            }
+            emit(ShedPolicy::Op::Not);
+            return true;
+        }
+        if (accept("-")) {
+            if (!parseUnary()) {
+                return false;
+            }
+            emit(ShedPolicy::Op::Negate);
+            return true;
+        }
+        return parsePrimary();
+    }
+
+    bool parsePrimary()
+    {
+        skipSpace();
+        if (position >= text.size()) {
+            return fail("Unexpected end of rule");
+        }
+        if (accept("(")) {
+            if (!parseLevel(0)) {
+                return false;
+            }
+            return accept(")") || fail("Expected ')'");
+        }
+
+        const char* start = text.c_str() + position;
+        if (std::isdigit(static_cast<unsigned char>(*start)) || *start == '.') {
+            char* end = nullptr;
+            float value = std::strtof(start, &end);
+            position += end - start;
+            emit(ShedPolicy::Op::Constant, ShedPolicy::Input::Load, value);
+            return true;
+        }
+
+        size_t length = 0;
+        while (position + length < text.size() &&
+               (std::isalnum(static_cast<unsigned char>(text[position + length])) || text[position + length] == '_')) {
+            ++length;
+        }
+        if (length == 0) {
+            return fail("Unexpected character");
+        }
+        std::string name = text.substr(position, length);
+        for (const NamedInput& named : namedInputs) {
+            if (name == named.name) {
+                position += length;
+                emit(ShedPolicy::Op::Input, named.input);
+                return true;
+            }
+        }
+        for (const NamedConstant& named : namedConstants) {
+            if (name == named.name) {
+                position += length;
+                emit(ShedPolicy::Op::Constant, ShedPolicy::Input::Load, named.value);
+                return true;
+            }
+        }
+        return fail(("Unknown name '" + name + "'").c_str());
+    }
+};
+
+} // namespace
+
+bool ShedPolicy::compile(const ShedPolicyConfig& config, std::string& error)
+{
+    code.clear();
+    stackDepth = 0;
+
+    RuleParser parser{ config.rule, 0, code, std::string() };
+    bool parsed = parser.parseLevel(0);
+    parser.skipSpace();
+    if (parsed && parser.position != config.rule.size()) {
+        parsed = parser.fail("Unexpected text");
+    }
+    if (!parsed) {
+        error = parser.error;
+        code.clear();
+        return false;
+    }
+    if (config.rotationGroups < 1 || config.rotationPeriod <= 0.0) {
+        error = "Rotation needs at least one group and a positive period";
+        code.clear();
+        return false;
+    }
+
+    // Fold constant right operands into their operator, so "load > 0.9"
+    // compares against an immediate instead of filling a block with 0.9
+    size_t folded = 0;
+    for (size_t i = 0; i < code.size(); ++i) {
+        Instruction instruction = code[i];
+        bool binary = instruction.op != Op::Input && instruction.op != Op::Constant &&
+                      instruction.op != Op::Negate && instruction.op != Op::Not;
+        if (binary && folded > 0 && code[folded - 1].op == Op::Constant) {
+            instruction.immediate = true;
+            instruction.constant = code[--folded].constant;
+        }
+        code[folded++] = instruction;
+    }
+    code.resize(folded);
+
+    // Deepest point of the value stack, for the scratch size
+    size_t depth = 0;
+    for (const Instruction& instruction : code) {
+        if (instruction.op == Op::Input || instruction.op == Op::Constant) {
+            stackDepth = std::max(stackDepth, ++depth);
+        } else if (instruction.op != Op::Negate && instruction.op != Op::Not && !instruction.immediate) {
+            --depth;
+        }
+    }
+    settings = config;
+    return true;
+}
+
+int ShedPolicy::rotationSlot(double time) const
+{
+    return static_cast<int>(static_cast<uint64_t>(std::max(time, 0.0) / settings.rotationPeriod) % settings.rotationGroups);
+}
+
+// --- Evaluation ---
+
+// a[j] = op(a[j], b[j]) over one block, or op(a[j], constant) for an immediate
+template <typename Operator>
+static void ApplyBinary(float* a, const float* b, const ShedPolicy::Instruction& instruction, size_t n, Operator op)
+{
+    if (instruction.immediate) {
+        const float constant = instruction.constant;
+        for (size_t j = 0; j < n; ++j) a[j] = op(a[j], constant);
+    } else {
+        for (size_t j = 0; j < n; ++j) a[j] = op(a[j], b[j]);
+    }
+}
+
+void ShedPolicy::loadInput(Input input, const ShedPolicyInputs& inputs, size_t base, size_t n, float* out) const
+{
+    switch (input) {
+        case Input::Load:
+            std::copy(inputs.load + base, inputs.load + base + n, out);
+            break;
+        case Input::MaxLoad:
+            std::copy(inputs.maxLoad + base, inputs.maxLoad + base + n, out);
+            break;
+        case Input::LoadRatio:
+            for (size_t j = 0; j < n; ++j) {
+                out[j] = inputs.load[base + j] / inputs.maxLoad[base + j];
+            }
+            break;
+        case Input::Priority:
+            for (size_t j = 0; j < n; ++j) {
+                out[j] = inputs.priority[base + j];
+            }
+            break;
+        case Input::State:
+            for (size_t j = 0; j < n; ++j) {
+                out[j] = inputs.state[base + j];
+            }
+            break;
+        case Input::TimeInState:
+            for (size_t j = 0; j < n; ++j) {
+                out[j] = static_cast<float>(inputs.time - inputs.stateChangeTime[base + j]);
+            }
+            break;
+        case Input::Prompt:
+            for (size_t j = 0; j < n; ++j) {
+                out[j] = inputs.showPrompt[base + j] ? 1.0f : 0.0f;
+            }
+            break;
+        case Input::Rotation: {
+            // Groups are round-robin by zone index, so the active group is every groups-th zone
+            const size_t groups = static_cast<size_t>(settings.rotationGroups);
+            const size_t slot = static_cast<size_t>(rotationSlot(inputs.time));
+            std::fill(out, out + n, 0.0f);
+            for (size_t j = (slot + groups - base % groups) % groups; j < n; j += groups) {
+                out[j] = 1.0f;
+            }
+            break;
+        }
+        case Input::GridLoadRatio:
+            std::fill(out, out + n, inputs.gridLoadRatio);
+            break;
+    }
+}
+
+size_t ShedPolicy::evaluate(const ShedPolicyInputs& inputs, float* scratch, int* zonesOut) const
+{
+    if (code.empty()) {
+        return 0;
+    }
+
+    size_t selected = 0;
+    for (size_t base = 0; base < inputs.count; base += blockSize) {
+        const size_t n = std::min(blockSize, inputs.count - base);
+        float* top = scratch - blockSize; // Slot of the value on top of the stack
+
+        for (const Instruction& instruction : code) {
+            // Binary operators fold the top slot into the one below it, or
+            // apply their immediate to the top slot
+            float* a = instruction.immediate ? top : top - blockSize;
+            const float* b = top;
+            switch (instruction.op) {
+                case Op::Input:
+                    top += blockSize;
+                    loadInput(instruction.input, inputs, base, n, top);
+                    continue;
+                case Op::Constant:
+                    top += blockSize;
+                    std::fill(top, top + n, instruction.constant);
+                    continue;
+                case Op::Negate:
+                    for (size_t j = 0; j < n; ++j) top[j] = -top[j];
+                    continue;
+                case Op::Not:
+                    for (size_t j = 0; j < n; ++j) top[j] = top[j] == 0.0f ? 1.0f : 0.0f;
+                    continue;
+                case Op::Add:          ApplyBinary(a, b, instruction, n, [](float x, float y) { return x + y; }); break;
+                case Op::Subtract:     ApplyBinary(a, b, instruction, n, [](float x, float y) { return x - y; }); break;
+                case Op::Multiply:     ApplyBinary(a, b, instruction, n, [](float x, float y) { return x * y; }); break;
+                case Op::Divide:       ApplyBinary(a, b, instruction, n, [](float x, float y) { return x / y; }); break;
+                case Op::Less:         ApplyBinary(a, b, instruction, n, [](float x, float y) { return x < y ? 1.0f : 0.0f; }); break;
+                case Op::LessEqual:    ApplyBinary(a, b, instruction, n, [](float x, float y) { return x <= y ? 1.0f : 0.0f; }); break;
+                case Op::Greater:      ApplyBinary(a, b, instruction, n, [](float x, float y) { return x > y ? 1.0f : 0.0f; }); break;
+                case Op::GreaterEqual: ApplyBinary(a, b, instruction, n, [](float x, float y) { return x >= y ? 1.0f : 0.0f; }); break;
+                case Op::Equal:        ApplyBinary(a, b, instruction, n, [](float x, float y) { return x == y ? 1.0f : 0.0f; }); break;
+                case Op::NotEqual:     ApplyBinary(a, b, instruction, n, [](float x, float y) { return x != y ? 1.0f : 0.0f; }); break;
+                case Op::And:          ApplyBinary(a, b, instruction, n, [](float x, float y) { return (x != 0.0f) & (y != 0.0f) ? 1.0f : 0.0f; }); break;
+                case Op::Or:           ApplyBinary(a, b, instruction, n, [](float x, float y) { return (x != 0.0f) | (y != 0.0f) ? 1.0f : 0.0f; }); break;
+            }
+            top = a;
+        }
+
+        // Rules usually select few zones: count each run of 64 first (a
+        // vectorised reduction) and only append inside runs that have any
+        for (size_t run = 0; run < n; run += 64) {
+            const size_t end = std::min<size_t>(run + 64, n);
+            int hits = 0;
+            for (size_t j = run; j < end; ++j) {
+                hits += top[j] != 0.0f;
+            }
+            if (hits == 0) {
+                continue;
+            }
+            // Same unconditional append as the zone sweep
+            for (size_t j = run; j < end; ++j) {
+                zonesOut[selected] = static_cast<int>(base + j);
+                selected += top[j] != 0.0f;
+            }
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,109 @@
+#ifndef SHED_POLICY_H
+#define SHED_POLICY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "simulation.h"
+
+// Load-shedding policy: a rule the simulation evaluates for every zone and
+// cuts the zones it selects, next to the auto-cut timeout and the operator.
+//
+// The rule is an expression over per-zone inputs, e.g.
+//
+//   load_ratio > 0.85 && priority >= 2 && rotation
+//
+// Inputs: load, max_load, load_ratio (load / max_load), priority (the zone's
+// tier, 0 = critical), state, time_in_state (seconds), prompt (operator
+// prompt open), rotation (the zone's blackout group is the active one) and
+// grid_load_ratio (demand over capacity of the whole grid).
+// Constants: numbers, true, false and the state names (NORMAL, WARNING,
+// OVERLOADED, POWER_CUT, COOLDOWN).
+// Operators, loosest first: || then && then == != < <= > >= then + - then
+// * / then unary ! and -. Comparisons and logic yield 0 or 1, anything
+// non-zero is true.
+//
+// compile() turns the rule into flat postfix bytecode once; evaluate() runs
+// each instruction over a block of zones at a time (a tight loop over the SoA
+// arrays the compiler can vectorise), so interpreting costs one dispatch per
+// instruction per block instead of per zone.
+//
+// Zones are split round-robin into rotationGroups blackout groups and the
+// active group advances every rotationPeriod seconds. The policy is armed
+// when the grid load ratio reaches armAbove and disarmed once it drops under
+// disarmBelow, so it does not flap around a single threshold; it only cuts
+// while armed. Zones already in POWER_CUT or COOLDOWN are never cut again, and
+// restoring is left to the usual power cut and cooldown timers.
+
+struct ShedPolicyConfig {
+    std::string rule;
+    double armAbove = 0.0;       // 0: always armed
+    double disarmBelow = 0.0;
+    int rotationGroups = 1;
+    double rotationPeriod = 60.0;
+    double interval = 0.1;       // Seconds between evaluations; 0 evaluates every step
+};
+
+// Per-zone inputs for one evaluation (pointers into the simulation's arrays)
+struct ShedPolicyInputs {
+    size_t count = 0;
+    const float* load = nullptr;
+    const float* maxLoad = nullptr;
+    const uint8_t* priority = nullptr;
+    const HouseState* state = nullptr;
+    const double* stateChangeTime = nullptr;
+    const uint8_t* showPrompt = nullptr;
+    double time = 0.0;
+    float gridLoadRatio = 0.0f;
+};
+
+class ShedPolicy
+{
+public:
+    static constexpr size_t blockSize = 256; // Zones per evaluation block
+
+    // False (with a message naming the column) if the rule does not parse
+    bool compile(const ShedPolicyConfig& config, std::string& error);
+
+    const ShedPolicyConfig& config() const { return settings; }
+    size_t instructionCount() const { return code.size(); }
+
+    // Scratch evaluate() needs: the value stack for one block
+    size_t scratchBytes() const { return stackDepth * blockSize * sizeof(float); }
+
+    // Active blackout group at `time`
+    int rotationSlot(double time) const;
+
+    // Write the zones the rule selects to `zonesOut` (room for inputs.count),
+    // in zone order, and return how many there are. `scratch` holds
+    // scratchBytes(); the policy itself is not modified, so one compiled
+    // policy can be shared by simulations on different threads.
+    size_t evaluate(const ShedPolicyInputs& inputs, float* scratch, int* zonesOut) const;
+
+    enum class Op : uint8_t {
+        Input, Constant,
+        Add, Subtract, Multiply, Divide, Negate,
+        Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual,
+        And, Or, Not
+    };
+
+    enum class Input : uint8_t {
+        Load, MaxLoad, LoadRatio, Priority, State, TimeInState, Prompt, Rotation, GridLoadRatio
+    };
+
+    struct Instruction {
+        Op op;
+        Input input;    // Op::Input
+        bool immediate; // Binary op whose right operand is `constant` (folded at compile time)
+        float constant; // Op::Constant, immediates
+    };
+
+private:
+    ShedPolicyConfig settings;
+    std::vector<Instruction> code;
+    size_t stackDepth = 0;
+
+    void loadInput(Input input, const ShedPolicyInputs& inputs, size_t base, size_t n, float* out) const;
+};
+
+#endif // SHED_POLICY_H
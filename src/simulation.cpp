@@ -0,0 +1,647 @@
+#include "simulation.h"
+#include "checkpoint.h"
+#include "load_profile.h"
+#include "shed_policy.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+const char* HouseStateName(HouseState state)
+{
+    switch (state) {
+        case NORMAL: return "NORMAL";
+        case WARNING: return "WARNING";
+        case OVERLOADED: return "OVERLOADED";
+        case POWER_CUT: return "POWER CUT";
+        case COOLDOWN: return "COOLDOWN";
+    }
+    return "UNKNOWN";
+}
+
+// --- GridTopology ---
+
+GridTopology GridTopology::makeDefault()
+{
+    GridTopology grid;
+    grid.generatorPos = glm::vec3(-0.8f, 0.3f, 0.0f);
+
+    // Transmitter shape has height 1.5 units relative to its local origin, scaled by 0.2f
+    grid.transmitterPositions = { glm::vec3(-0.4f, 0.0f, 0.0f), glm::vec3(0.4f, 0.3f, 0.0f) };
+    for (const glm::vec3& base : grid.transmitterPositions) {
+        grid.transmitterTops.push_back(base + glm::vec3(0.0f, 1.5f * 0.2f, 0.0f));
+    }
+
+    // House 1 and 2 are connected to Transmitter 1, House 3 and 4 to Transmitter 2
+    const float houseX[4] = { -0.6f, -0.2f, 0.2f, 0.6f };
+    for (int i = 0; i < 4; ++i) {
+        grid.zoneNames.push_back("House " + std::to_string(i + 1));
+        grid.zonePositions.push_back(glm::vec3(houseX[i], -0.4f, 0.0f));
+        grid.zoneFeeder.push_back(i < 2 ? 0 : 1);
+        grid.maxLoad.push_back(1.0f);
+        grid.warningThreshold.push_back(0.6f);
+        grid.overloadThreshold.push_back(0.9f);
+    }
+    grid.zonePriority = { 0, 1, 2, 2 }; // House 1 is the critical load
+
+    // Phase 1: Generator to Transmitters (8 circles total, 4 to each)
+    float genToTxDuration = 2.0f;
+    float genToTxStagger = genToTxDuration / 4.0f;
+    for (int i = 0; i < 4; ++i) {
+        for (const glm::vec3& top : grid.transmitterTops) {
+            grid.flows.push_back({grid.generatorPos, top, genToTxDuration, (float)i * genToTxStagger, -1});
+        }
+    }
+
+    // Phase 2: Transmitters to Houses (8 circles total, 2 to each house)
+    float txToHouseDuration = 1.5f;
+    float txToHouseStagger = txToHouseDuration / 2.0f;
+    for (int i = 0; i < 2; ++i) {
+        for (int house = 0; house < 4; ++house) {
+            const glm::vec3& top = grid.transmitterTops[grid.zoneFeeder[house]];
+            grid.flows.push_back({top, grid.zonePositions[house], txToHouseDuration, (float)i * txToHouseStagger + genToTxDuration, house});
+        }
+    }
+
+    return grid;
+}
+
+GridTopology GridTopology::makeSynthetic(size_t zoneCount, uint64_t seed)
+{
+    const size_t zonesPerTransmitter = 64;
+
+    GridTopology grid;
+    Rng rng(seed);
+    grid.generatorPos = glm::vec3(-0.9f, 0.75f, 0.0f);
+
+    // Lattice twice as wide as it is tall, filling the lower part of the screen
+    size_t columns = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(2.0 * zoneCount))));
+    size_t rows = std::max<size_t>(1, (zoneCount + columns - 1) / columns);
+    grid.markerScale = std::min(0.2f, 1.6f / columns);
+
+    size_t transmitterCount = std::max<size_t>(1, (zoneCount + zonesPerTransmitter - 1) / zonesPerTransmitter);
+    for (size_t t = 0; t < transmitterCount; ++t) {
+        glm::vec3 base(-0.95f + 1.9f * (t + 0.5f) / transmitterCount, 0.2f, 0.0f);
+        grid.transmitterPositions.push_back(base);
+        grid.transmitterTops.push_back(base + glm::vec3(0.0f, 1.5f * grid.markerScale, 0.0f));
+    }
+
+    grid.zoneNames.reserve(zoneCount);
+    grid.zonePositions.reserve(zoneCount);
+    grid.zoneFeeder.reserve(zoneCount);
+    grid.maxLoad.reserve(zoneCount);
+    grid.warningThreshold.reserve(zoneCount);
+    grid.overloadThreshold.reserve(zoneCount);
+    grid.zonePriority.reserve(zoneCount);
+    for (size_t i = 0; i < zoneCount; ++i) {
+        size_t row = i / columns;
+        size_t column = i % columns;
+        float maxLoad = 0.8f + 0.4f * (rng.next() / 4294967296.0f);
+        grid.zoneNames.push_back("Zone " + std::to_string(i + 1));
+        grid.zonePositions.push_back(glm::vec3(-0.95f + 1.9f * (column + 0.5f) / columns,
+                                               -0.95f + 1.05f * (row + 0.5f) / rows, 0.0f));
+        grid.zoneFeeder.push_back(static_cast<int>(i / zonesPerTransmitter));
+        grid.maxLoad.push_back(maxLoad);
+        grid.warningThreshold.push_back(0.6f * maxLoad);
+        grid.overloadThreshold.push_back(0.9f * maxLoad);
+        // About 10% critical, 30% tier 1, the rest tier 2 (hashed so the max load draws stay the same)
+        uint32_t tierHash = (static_cast<uint32_t>(i) * 2654435761u) >> 16;
+        grid.zonePriority.push_back(static_cast<uint8_t>(tierHash % 10 == 0 ? 0 : (tierHash % 10 < 4 ? 1 : 2)));
+    }
+
+    // Same two flow phases as the demo grid: one circle per transmitter, one per zone
+    float genToTxDuration = 2.0f;
+    for (size_t t = 0; t < transmitterCount; ++t) {
+        grid.flows.push_back({grid.generatorPos, grid.transmitterTops[t], genToTxDuration,
+                              genToTxDuration * (rng.next() / 4294967296.0f), -1});
+    }
+    float txToHouseDuration = 1.5f;
+    for (size_t i = 0; i < zoneCount; ++i) {
+        grid.flows.push_back({grid.transmitterTops[grid.zoneFeeder[i]], grid.zonePositions[i], txToHouseDuration,
+                              genToTxDuration + txToHouseDuration * (rng.next() / 4294967296.0f), static_cast<int>(i)});
+    }
+
+    return grid;
+}
+
+ZoneBox GridTopology::zoneBounds(size_t zone) const
+{
+    glm::vec2 base(zonePositions[zone]);
+    return { base - glm::vec2(0.5f * markerScale, 0.0f), base + glm::vec2(0.5f * markerScale, 0.5f * markerScale) };
+}
+
+void ZoneArrays::resize(size_t count)
+{
+    currentLoad.resize(count);
+    state.resize(count);
+    stateChangeTime.resize(count);
+    showPowerCutPrompt.resize(count);
+    isManualCut.resize(count);
+}
+
+// --- Rng (PCG32, O'Neill 2014) ---
+
+Rng::Rng(uint64_t seed, uint64_t stream)
+    : state(0), increment((stream << 1u) | 1u)
+{
+    next();
+    state += seed;
+    next();
+}
+
+uint32_t Rng::next()
+{
+    uint64_t old = state;
+    state = old * 6364136223846793005ULL + increment;
+    uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = static_cast<uint32_t>(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+uint32_t Rng::below(uint32_t bound)
+{
+    // Rejection sampling avoids the modulo bias of rand() % n
+    uint32_t threshold = (0u - bound) % bound;
+    for (;;) {
+        uint32_t r = next();
+        if (r >= threshold) {
+            return r % bound;
+        }
+    }
+}
+
+// --- Zone state machine ---
+// One row per state: what ends it, where it goes and what to log. Timed
+// states end once the zone has been in them for their timeout (from params);
+// OVERLOADED is held while its operator prompt is open, and WARNING ends when
+// the load drops under the warning threshold instead. NORMAL only changes
+// through overload events and commands.
+struct ZoneTransition {
+    HouseState next;
+    bool timed;             // Fires after the state's timeout...
+    bool heldByPrompt;      // ...unless the power cut prompt is open
+    bool belowWarning;      // Fires when the load drops under warningThreshold
+    bool automaticCut;      // Side effect: not a manual cut, overload flows cleared
+    const char* message;    // Logged with the zone name
+};
+
+static const ZoneTransition zoneTransitions[] = {
+    /* NORMAL */     { NORMAL,    false, false, false, false, nullptr },
+    /* WARNING */    { NORMAL,    false, false, true,  false, "%s returned to NORMAL from WARNING (load dropped)." },
+    /* OVERLOADED */ { POWER_CUT, true,  true,  false, true,  "%s: Automatic power cut due to prolonged overload." },
+    /* POWER_CUT */  { COOLDOWN,  true,  false, false, false, "%s: Power cut cooldown started." },
+    /* COOLDOWN */   { NORMAL,    true,  false, false, false, "%s: Power restored. Returning to NORMAL." },
+};
+static const int zoneStateCount = sizeof(zoneTransitions) / sizeof(zoneTransitions[0]);
+
+// A transition that fired this step, applied after the sweep
+struct FiredTransition {
+    int zone;
+    HouseState from;
+};
+
+// Everything in a checkpoint that is not a per-zone or per-flow array
+struct CheckpointScalars {
+    uint64_t zoneCount;
+    uint64_t topologyHash;
+    double currentTime;
+    uint64_t steps;
+    double lastOverloadEventTime;
+    double lastPolicyTime;
+    Rng rng;
+    SimulationStats statistics;
+    int32_t promptZone;
+    uint8_t policyArmed;
+    uint8_t reserved[3]; // Explicit padding, zero
+    float gridLoadRatio;
+    uint32_t reserved2;
+};
+static_assert(std::is_trivially_copyable<CheckpointScalars>::value, "checkpoint scalars are stored as raw bytes");
+static_assert(sizeof(CheckpointScalars) == 136, "no implicit padding, so equal states give equal files");
+
+// FNV-1a over what the simulation reads from the grid per zone
+static uint64_t HashTopology(const GridTopology& grid)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash = (hash ^ p[i]) * 0x100000001b3ULL;
+        }
+    };
+    const size_t count = grid.zoneCount();
+    mix(&count, sizeof(count));
+    mix(grid.maxLoad.data(), count * sizeof(float));
+    mix(grid.zoneFeeder.data(), count * sizeof(int));
+    mix(grid.zonePriority.data(), grid.zonePriority.size());
+    return hash;
+}
+
+// --- Simulation ---
+
+Simulation::Simulation(std::shared_ptr<const GridTopology> topology, uint64_t seed, SimulationParams params)
+    : params(params), grid(std::move(topology)), overloadFlows(params.maxOverloadFlows, grid->zoneCount()), rng(seed), loadProfile(nullptr), currentTime(0.0), steps(0),
+      lastOverloadEventTime(-params.overloadInterval), // Allow an immediate first overload
+      promptZone(-1),
+      policyArmed(false), lastPolicyTime(-std::numeric_limits<double>::infinity()), totalMaxLoad(0.0f), gridLoadRatio(0.0f),
+      topologyHash(0),
+      commands(params.commandCapacity), commandsDropped(0),
+      // Room for a full candidate, fired and policy list, sampled loads and the policy's value stack
+      stepArena(grid->zoneCount() * (2 * sizeof(int) + sizeof(FiredTransition) + sizeof(float)) +
+                (params.shedPolicy ? params.shedPolicy->scratchBytes() : 0) + 4096)
+{
+    size_t count = grid->zoneCount();
+    zoneState.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        totalMaxLoad += grid->maxLoad[i];
+        zoneState.currentLoad[i] = 0.5f * grid->maxLoad[i];
+        zoneState.state[i] = NORMAL;
+        zoneState.stateChangeTime[i] = 0.0;
+        zoneState.showPowerCutPrompt[i] = false;
+        zoneState.isManualCut[i] = false;
+    }
+    topologyHash = HashTopology(*grid);
+    eventLog.add("Simulation started.");
+}
+
+void Simulation::saveCheckpoint(CheckpointWriter& writer) const
+{
+    CheckpointScalars scalars = {
+        grid->zoneCount(), topologyHash, currentTime, steps, lastOverloadEventTime, lastPolicyTime, rng, statistics,
+        promptZone, static_cast<uint8_t>(policyArmed ? 1 : 0), { 0, 0, 0 }, gridLoadRatio, 0
+    };
+    writer.addCopy(CheckpointSection::SimulationScalars, &scalars, sizeof(scalars));
+
+    writer.addArray(CheckpointSection::ZoneLoad, zoneState.currentLoad);
+    writer.addArray(CheckpointSection::ZoneState, zoneState.state);
+    writer.addArray(CheckpointSection::ZoneStateChangeTime, zoneState.stateChangeTime);
+    writer.addArray(CheckpointSection::ZonePrompt, zoneState.showPowerCutPrompt);
+    writer.addArray(CheckpointSection::ZoneManualCut, zoneState.isManualCut);
+    overloadFlows.saveCheckpoint(writer);
+}
+
+bool Simulation::restoreCheckpoint(const CheckpointReader& reader)
+{
+    PROFILE_SCOPE("Restore checkpoint");
+    CheckpointScalars scalars;
+    if (!reader.read(CheckpointSection::SimulationScalars, &scalars, sizeof(scalars))) {
+        std::cerr << "ERROR::CHECKPOINT::MISSING_SIMULATION_STATE\n";
+        return false;
+    }
+    const size_t count = grid->zoneCount();
+    if (scalars.zoneCount != count || scalars.topologyHash != topologyHash) {
+        std::cerr << "ERROR::CHECKPOINT::TOPOLOGY_MISMATCH checkpoint has " << scalars.zoneCount << " zones, simulation has "
+                  << count << "\n";
+        return false;
+    }
+    // Check every section before touching any state
+    bool fits = reader.has(CheckpointSection::ZoneLoad, count * sizeof(float)) &&
+                reader.has(CheckpointSection::ZoneState, count * sizeof(HouseState)) &&
+                reader.has(CheckpointSection::ZoneStateChangeTime, count * sizeof(double)) &&
+                reader.has(CheckpointSection::ZonePrompt, count * sizeof(uint8_t)) &&
+                reader.has(CheckpointSection::ZoneManualCut, count * sizeof(uint8_t));
+    if (!fits) {
+        std::cerr << "ERROR::CHECKPOINT::LAYOUT_MISMATCH (different maxOverloadFlows?)\n";
+        return false;
+    }
+    // Indices and states index arrays in step(), so out-of-range values must never get in
+    std::vector<HouseState> states(count);
+    reader.readArray(CheckpointSection::ZoneState, states);
+    bool valid = scalars.promptZone >= -1 && scalars.promptZone < static_cast<int64_t>(count);
+    for (size_t i = 0; i < count && valid; ++i) {
+        valid = states[i] <= COOLDOWN;
+    }
+    if (!valid) {
+        std::cerr << "ERROR::CHECKPOINT::CORRUPT_ZONE_STATE\n";
+        return false;
+    }
+    if (!overloadFlows.canRestore(reader)) {
+        std::cerr << "ERROR::CHECKPOINT::CORRUPT_FLOWS (or a different maxOverloadFlows)\n";
+        return false;
+    }
+
+    reader.readArray(CheckpointSection::ZoneLoad, zoneState.currentLoad);
+    zoneState.state.swap(states);
+    reader.readArray(CheckpointSection::ZoneStateChangeTime, zoneState.stateChangeTime);
+    reader.readArray(CheckpointSection::ZonePrompt, zoneState.showPowerCutPrompt);
+    reader.readArray(CheckpointSection::ZoneManualCut, zoneState.isManualCut);
+    overloadFlows.restoreCheckpoint(reader);
+
+    currentTime = scalars.currentTime;
+    steps = scalars.steps;
+    lastOverloadEventTime = scalars.lastOverloadEventTime;
+    lastPolicyTime = scalars.lastPolicyTime;
+    rng = scalars.rng;
+    statistics = scalars.statistics;
+    promptZone = scalars.promptZone;
+    policyArmed = scalars.policyArmed != 0;
+    gridLoadRatio = scalars.gridLoadRatio;
+    eventLog.add("Restored checkpoint at t = %.2f s.", currentTime);
+    return true;
+}
+
+bool Simulation::postCommand(const SimCommand& command)
+{
+    if (!commands.push(command)) {
+        commandsDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void Simulation::step(double dt)
+{
+    PROFILE_SCOPE("Simulation step");
+    currentTime += dt;
+    ++steps;
+
+    applyCommands();
+
+    // --- Overload Management Logic ---
+    // This ensures only one house goes into OVERLOADED state every overloadInterval seconds
+    if (currentTime - lastOverloadEventTime >= params.overloadInterval) {
+        lastOverloadEventTime = currentTime; // Reset timer for the next overload event
+        triggerOverloadEvent();
+    }
+
+    updateZones(dt);
+    applyShedPolicy();
+    stepArena.reset();
+}
+
+void Simulation::applyCommands()
+{
+    // At most one queue's worth per step, so producers that keep posting
+    // cannot hold the step up; the rest waits for the next step
+    SimCommand command;
+    for (size_t drained = 0; drained < commands.capacity() && commands.pop(command); ++drained) {
+        applyCommand(command);
+    }
+}
+
+void Simulation::applyCommand(const SimCommand& command)
+{
+    int i = command.zone;
+    if (i < 0 || i >= static_cast<int>(grid->zoneCount())) {
+        return;
+    }
+    const char* name = grid->zoneNames[i].c_str();
+
+    switch (command.type) {
+        case SimCommandType::ManualShed:
+        case SimCommandType::ConfirmCut:
+            if (zoneState.state[i] != OVERLOADED) {
+                return; // The house recovered or was cut in the meantime
+            }
+            zoneState.state[i] = POWER_CUT;
+            zoneState.stateChangeTime[i] = currentTime;
+            zoneState.isManualCut[i] = true;
+            zoneState.showPowerCutPrompt[i] = false; // Close prompt if open
+            ++statistics.manualCuts;
+            eventLog.add(command.type == SimCommandType::ManualShed ? "%s: Manual power cut initiated."
+                                                                    : "%s: Manual power cut confirmed.", name);
+            clearOverloadFlows(i); // Clear circles on manual power cut
+            if (promptZone == i) {
+                promptZone = -1;
+            }
+            break;
+
+        case SimCommandType::DeclineCut:
+            zoneState.showPowerCutPrompt[i] = false; // Dismiss prompt
+            eventLog.add("%s: Manual power cut declined. Monitoring...", name);
+            if (promptZone == i) {
+                promptZone = -1;
+            }
+            break;
+    }
+}
+
+void Simulation::triggerOverloadEvent()
+{
+    PROFILE_SCOPE("Overload event");
+    // Reset all houses to NORMAL if they are not in POWER_CUT/COOLDOWN
+    // and clear any pending prompts or overload circles from previous cycles
+    for (size_t i = 0; i < grid->zoneCount(); ++i) {
+        HouseState state = zoneState.state[i];
+        if (state != POWER_CUT && state != COOLDOWN) {
+            if (state != NORMAL) { // Only log if actually changing state
+                eventLog.add("%s reset to NORMAL for new cycle.", grid->zoneNames[i].c_str());
+            }
+            zoneState.state[i] = NORMAL;
+            zoneState.showPowerCutPrompt[i] = false;
+            clearOverloadFlows(static_cast<int>(i)); // Clear any lingering overload circles
+        }
+    }
+    promptZone = -1; // Ensure no modal is active from previous cycle
+
+    // Select a random house that is currently in NORMAL or WARNING state to overload
+    std::pmr::vector<int> candidateZones(&stepArena);
+    candidateZones.reserve(grid->zoneCount());
+    for (size_t i = 0; i < grid->zoneCount(); ++i) {
+        if (zoneState.state[i] == NORMAL || zoneState.state[i] == WARNING) {
+            candidateZones.push_back(static_cast<int>(i));
+        }
+    }
+
+    if (candidateZones.empty()) {
+        eventLog.add("No available houses to overload. All are in POWER_CUT or COOLDOWN.");
+        return;
+    }
+
+    int zone = candidateZones[rng.below(static_cast<uint32_t>(candidateZones.size()))];
+    zoneState.state[zone] = OVERLOADED;
+    zoneState.stateChangeTime[zone] = currentTime;
+    zoneState.showPowerCutPrompt[zone] = params.operatorPrompt;
+    zoneState.isManualCut[zone] = false; // It's an automatic overload trigger
+    promptZone = params.operatorPrompt ? zone : -1;
+    ++statistics.overloadEvents;
+    eventLog.add("FORCING %s into OVERLOADED state.", grid->zoneNames[zone].c_str());
+    spawnOverloadFlows(zone);
+}
+
+void Simulation::updateZones(double dt)
+{
+    // Per-step copy of the table in the shape the sweep indexes (timeouts can change between steps)
+    const double never = std::numeric_limits<double>::infinity();
+    const double stateTimeout[zoneStateCount] = { never, never, params.autoCutTimeout, params.powerCutDuration, params.cooldownDuration };
+    uint8_t nextState[zoneStateCount], heldByPrompt[zoneStateCount], belowWarning[zoneStateCount];
+    for (int s = 0; s < zoneStateCount; ++s) {
+        nextState[s] = zoneTransitions[s].next;
+        heldByPrompt[s] = zoneTransitions[s].heldByPrompt;
+        belowWarning[s] = zoneTransitions[s].belowWarning;
+    }
+
+    const size_t count = grid->zoneCount();
+    const float* maxLoad = grid->maxLoad.data();
+    const float* warningThreshold = grid->warningThreshold.data();
+    float* currentLoad = zoneState.currentLoad.data();
+    HouseState* state = zoneState.state.data();
+    double* stateChangeTime = zoneState.stateChangeTime.data();
+    const uint8_t* showPrompt = zoneState.showPowerCutPrompt.data();
+
+    // Profile loads for this step, sampled up front so the sweep stays one pass
+    const float* profileLoad = nullptr;
+    if (loadProfile) {
+        float* sampled = static_cast<float*>(stepArena.allocate(count * sizeof(float), alignof(float)));
+        loadProfile->sample(currentTime, sampled);
+        profileLoad = sampled;
+    }
+
+    // Room for every zone, so appending needs no capacity check
+    FiredTransition* fired = static_cast<FiredTransition*>(stepArena.allocate(count * sizeof(FiredTransition), alignof(FiredTransition)));
+    size_t firedCount = 0;
+    size_t cutZones = 0;
+    size_t overloadedZones = 0;
+    float shedLoad = 0.0f;
+    float demand = 0.0f;
+
+    // Branch-free sweep: the state only selects table entries, transitions are
+    // masked selects, and fired zones are appended unconditionally (the count
+    // advances only when the transition fired)
+    for (size_t i = 0; i < count; ++i) {
+        const HouseState current = state[i];
+
+        // Dynamic load fluctuation (using sine wave with random offset for variety), none during a power cut
+        float load;
+        if (profileLoad) {
+            load = profileLoad[i];
+        } else {
+            float fluctuationFactor = (sin(currentTime * (0.5f + i * 0.1f) + (float)i * 2.0f) + 1.0f) / 2.0f; // 0.0 to 1.0
+            load = maxLoad[i] * (0.3f + 0.7f * fluctuationFactor); // Load between 30% and 100% of maxLoad
+        }
+        load = glm::clamp(load, 0.0f, maxLoad[i]);
+        demand += load;
+        const bool cut = current == POWER_CUT;
+        cutZones += cut;
+        overloadedZones += current == OVERLOADED;
+        shedLoad += cut ? load : 0.0f; // What the zone would have drawn
+        load = cut ? 0.0f : load;
+        currentLoad[i] = load;
+
+        bool timedOut = (currentTime - stateChangeTime[i] >= stateTimeout[current]) & !(heldByPrompt[current] & showPrompt[i]);
+        bool loadDropped = belowWarning[current] & (load < warningThreshold[i]);
+        bool fire = timedOut | loadDropped;
+
+        fired[firedCount] = { static_cast<int>(i), current };
+        firedCount += fire;
+        state[i] = fire ? static_cast<HouseState>(nextState[current]) : current;
+    }
+    statistics.shedEnergy += shedLoad * dt;
+    statistics.outageSeconds += cutZones * dt;
+    statistics.overloadSeconds += overloadedZones * dt;
+    gridLoadRatio = totalMaxLoad > 0.0f ? demand / totalMaxLoad : 0.0f;
+
+    // Timers, logging and side effects, in zone order (writing the timers here
+    // instead of in the sweep keeps the sweep from dirtying every timer's cache line)
+    for (size_t f = 0; f < firedCount; ++f) {
+        const ZoneTransition& transition = zoneTransitions[fired[f].from];
+        int zone = fired[f].zone;
+        stateChangeTime[zone] = currentTime;
+        eventLog.add(transition.message, grid->zoneNames[zone].c_str());
+        if (transition.automaticCut) {
+            ++statistics.automaticCuts;
+            zoneState.isManualCut[zone] = false;
+            clearOverloadFlows(zone); // Clear circles on power cut
+        }
+    }
+}
+
+// Cut the zones the shedding policy selects (see shed_policy.h)
+void Simulation::applyShedPolicy()
+{
+    const ShedPolicy* policy = params.shedPolicy.get();
+    if (!policy || currentTime - lastPolicyTime < policy->config().interval) {
+        return;
+    }
+    PROFILE_SCOPE("Shedding policy");
+    lastPolicyTime = currentTime;
+
+    // Hysteresis on the grid load ratio
+    const ShedPolicyConfig& config = policy->config();
+    if (config.armAbove <= 0.0) {
+        policyArmed = true;
+    } else if (!policyArmed && gridLoadRatio >= config.armAbove) {
+        policyArmed = true;
+        eventLog.add("Shedding policy armed (grid load %.0f%%).", gridLoadRatio * 100.0f);
+    } else if (policyArmed && gridLoadRatio < config.disarmBelow) {
+        policyArmed = false;
+        eventLog.add("Shedding policy disarmed (grid load %.0f%%).", gridLoadRatio * 100.0f);
+    }
+    if (!policyArmed) {
+        return;
+    }
+
+    const size_t count = grid->zoneCount();
+    ShedPolicyInputs inputs;
+    inputs.count = count;
+    inputs.load = zoneState.currentLoad.data();
+    inputs.maxLoad = grid->maxLoad.data();
+    inputs.priority = grid->zonePriority.data();
+    inputs.state = zoneState.state.data();
+    inputs.stateChangeTime = zoneState.stateChangeTime.data();
+    inputs.showPrompt = zoneState.showPowerCutPrompt.data();
+    inputs.time = currentTime;
+    inputs.gridLoadRatio = gridLoadRatio;
+
+    float* scratch = static_cast<float*>(stepArena.allocate(policy->scratchBytes(), alignof(float)));
+    int* selected = static_cast<int*>(stepArena.allocate(count * sizeof(int), alignof(int)));
+    size_t selectedCount = policy->evaluate(inputs, scratch, selected);
+
+    for (size_t s = 0; s < selectedCount; ++s) {
+        int zone = selected[s];
+        HouseState state = zoneState.state[zone];
+        if (state == POWER_CUT || state == COOLDOWN) {
+            continue;
+        }
+        zoneState.state[zone] = POWER_CUT;
+        zoneState.stateChangeTime[zone] = currentTime;
+        zoneState.isManualCut[zone] = false;
+        zoneState.showPowerCutPrompt[zone] = false;
+        if (promptZone == zone) {
+            promptZone = -1;
+        }
+        ++statistics.policyCuts;
+        eventLog.add("%s: Power cut by shedding policy.", grid->zoneNames[zone].c_str());
+        if (state == OVERLOADED) {
+            clearOverloadFlows(zone);
+        }
+    }
+}
+
+// Spawn additional flows from the feeding transmitter to an overloaded house
+void Simulation::spawnOverloadFlows(int zone)
+{
+    const glm::vec3& txPos = grid->transmitterTops[grid->zoneFeeder[zone]];
+    for (int i = 0; i < 2; ++i) {
+        overloadFlows.spawn({
+            txPos,
+            grid->zonePositions[zone],
+            1.0f,            // Faster duration for overload circles
+            (float)i * 0.5f, // Stagger them
+            zone
+        });
+    }
+    eventLog.add("Spawned 2 overload circles for %s", grid->zoneNames[zone].c_str());
+}
+
+// Remove the overload flows going to a specific house
+void Simulation::clearOverloadFlows(int zone)
+{
+    overloadFlows.clearZone(zone);
+    eventLog.add("Cleared overload circles for %s", grid->zoneNames[zone].c_str());
+}
+
+void Simulation::fillSnapshot(SimSnapshot& snapshot) const
+{
+    PROFILE_SCOPE("Publish snapshot");
+    // assign() reuses the slot's capacity, so steady-state publishing does not allocate
+    snapshot.step = steps;
+    snapshot.time = currentTime;
+    snapshot.promptZone = promptZone;
+    snapshot.currentLoad.assign(zoneState.currentLoad.begin(), zoneState.currentLoad.end());
+    snapshot.state.assign(zoneState.state.begin(), zoneState.state.end());
+    snapshot.showPowerCutPrompt.assign(zoneState.showPowerCutPrompt.begin(), zoneState.showPowerCutPrompt.end());
+    overloadFlows.copyTo(snapshot.overloadFlows);
+}
@@ -0,0 +1,223 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "event_log.h"
+#include "flow_pool.h"
+#include "frame_arena.h"
+#include "mpsc_queue.h"
+
+class CheckpointReader;
+class CheckpointWriter;
+class LoadProfile;
+class ShedPolicy;
+
+// --- Zone state ---
+
+enum HouseState : uint8_t {
+    NORMAL,
+    WARNING,
+    OVERLOADED,
+    POWER_CUT,
+    COOLDOWN
+};
+
+const char* HouseStateName(HouseState state);
+
+// Axis-aligned box in scene coordinates
+struct ZoneBox {
+    glm::vec2 min;
+    glm::vec2 max;
+};
+
+// --- Immutable grid description ---
+// Shared between the simulation, the renderer and (later) simulation replicas.
+
+struct GridTopology {
+    glm::vec3 generatorPos;
+    std::vector<glm::vec3> transmitterPositions; // Base of each transmitter tower
+    std::vector<glm::vec3> transmitterTops;      // Where flows enter/leave a transmitter
+
+    // Per zone (SoA)
+    std::vector<std::string> zoneNames;
+    std::vector<glm::vec3> zonePositions;
+    std::vector<int> zoneFeeder; // Transmitter index feeding each zone
+    std::vector<float> maxLoad;
+    std::vector<float> warningThreshold;
+    std::vector<float> overloadThreshold;
+    std::vector<uint8_t> zonePriority; // Shedding tier: 0 = critical, higher tiers go first
+
+    // Steady flows drawn regardless of overloads
+    std::vector<FlowPath> flows;
+
+    float markerScale = 0.2f; // Drawn size of houses and transmitter towers
+
+    size_t zoneCount() const { return zoneNames.size(); }
+
+    // The drawn house: markerScale wide by markerScale * 0.5 high, standing on the zone position
+    ZoneBox zoneBounds(size_t zone) const;
+
+    // The four-house demo grid
+    static GridTopology makeDefault();
+
+    // Large generated grid for benchmarks: zones on a regular lattice, one
+    // transmitter per 64 zones, per-zone max load jittered by `seed`
+    static GridTopology makeSynthetic(size_t zoneCount, uint64_t seed = 1);
+};
+
+// --- Mutable simulation state ---
+
+// Per-zone state, one array per field so the update loops stream through memory
+struct ZoneArrays {
+    std::vector<float> currentLoad;
+    std::vector<HouseState> state;
+    std::vector<double> stateChangeTime;   // Time when the state last changed (for timers)
+    std::vector<uint8_t> showPowerCutPrompt; // Operator prompt pending for this zone
+    std::vector<uint8_t> isManualCut;      // Was the power cut manual or automatic?
+
+    void resize(size_t count);
+};
+
+// Policy knobs; defaults match the original hard-coded behaviour
+struct SimulationParams {
+    double overloadInterval = 15.0; // Seconds between forced overload events
+    double autoCutTimeout = 10.0;   // Overloaded this long (without a prompt) -> power cut
+    double powerCutDuration = 5.0;  // POWER_CUT -> COOLDOWN
+    double cooldownDuration = 5.0;  // COOLDOWN -> NORMAL
+    size_t maxOverloadFlows = 256;  // Pool capacity; spawns beyond it are dropped
+    size_t commandCapacity = 4096;  // Commands queued between two steps; posts beyond it are dropped
+    bool operatorPrompt = true;     // Forced overloads wait on the Power Cut Confirmation prompt;
+                                    // batch runs turn it off so the auto-cut timeout decides
+    std::shared_ptr<const ShedPolicy> shedPolicy; // Optional rule-based shedding (shed_policy.h)
+};
+
+// Running totals since the simulation started
+struct SimulationStats {
+    double shedEnergy = 0.0;      // Load not served during power cuts (load units x seconds)
+    double outageSeconds = 0.0;   // Zone-seconds spent in POWER_CUT
+    double overloadSeconds = 0.0; // Zone-seconds spent in OVERLOADED
+    uint64_t overloadEvents = 0;
+    uint64_t automaticCuts = 0;
+    uint64_t manualCuts = 0;
+    uint64_t policyCuts = 0;
+};
+
+// Small, trivially copyable PRNG (PCG32) so every simulation owns its stream
+struct Rng {
+    uint64_t state;
+    uint64_t increment;
+
+    explicit Rng(uint64_t seed = 0x853c49e6748fea9bULL, uint64_t stream = 0xda3e39cb94b95bdbULL);
+    uint32_t next();
+    uint32_t below(uint32_t bound); // Uniform in [0, bound)
+};
+
+// Operator actions, applied by the simulation at the start of the next step
+enum class SimCommandType : uint8_t {
+    ManualShed,  // "Manual Shed" button
+    ConfirmCut,  // Power Cut Confirmation: yes
+    DeclineCut   // Power Cut Confirmation: no
+};
+
+struct SimCommand {
+    SimCommandType type;
+    int zone;
+};
+
+// What the renderer and UI see of the simulation: a self-contained copy
+// published after every batch of steps.
+struct SimSnapshot {
+    uint64_t step = 0;
+    double time = 0.0;
+    int promptZone = -1; // Zone waiting on the Power Cut Confirmation modal
+    std::vector<float> currentLoad;
+    std::vector<HouseState> state;
+    std::vector<uint8_t> showPowerCutPrompt;
+    std::vector<FlowPath> overloadFlows;
+};
+
+class Simulation
+{
+public:
+    Simulation(std::shared_ptr<const GridTopology> topology, uint64_t seed, SimulationParams params = SimulationParams());
+
+    // Advance the simulation clock by `dt` seconds
+    void step(double dt);
+
+    // Thread-safe and lock-free: queue an operator action for the next step.
+    // False (and counted in droppedCommands) if the queue is full.
+    bool postCommand(const SimCommand& command);
+    uint64_t droppedCommands() const { return commandsDropped.load(std::memory_order_relaxed); }
+
+    void fillSnapshot(SimSnapshot& snapshot) const;
+
+    // Checkpoint the complete mutable state (checkpoint.h): zones and their
+    // timers, overload flows, the RNG stream, the overload scheduler, the
+    // policy hysteresis and the statistics. Not included: commands still
+    // queued, the event log and a CSV load profile's read position. The writer
+    // refers to the simulation's arrays, so write it out before the next step.
+    void saveCheckpoint(CheckpointWriter& writer) const;
+    // Restore a checkpoint of a simulation with the same topology and
+    // maxOverloadFlows; params stay as they are, so what-if branches can
+    // differ in policy. False (after printing the reason, state unchanged) if
+    // the checkpoint does not fit.
+    bool restoreCheckpoint(const CheckpointReader& reader);
+    // Start a new random stream, e.g. so replicas branched from one checkpoint diverge
+    void reseed(uint64_t seed) { rng = Rng(seed); }
+
+    // Drive zone loads from `profile` (not owned) instead of the synthetic
+    // sine wave; nullptr goes back to the sine wave
+    void setLoadProfile(LoadProfile* profile) { loadProfile = profile; }
+
+    double time() const { return currentTime; }
+    uint64_t stepCount() const { return steps; }
+    const GridTopology& topology() const { return *grid; }
+    const ZoneArrays& zones() const { return zoneState; }
+    const SimulationStats& stats() const { return statistics; }
+    int pendingPromptZone() const { return promptZone; } // -1 if no Power Cut Confirmation is pending
+    EventLog& log() { return eventLog; }
+
+    SimulationParams params;
+
+private:
+    void applyCommands();
+    void applyCommand(const SimCommand& command);
+    void triggerOverloadEvent();
+    void updateZones(double dt);
+    void applyShedPolicy();
+
+    void spawnOverloadFlows(int zone);
+    void clearOverloadFlows(int zone);
+
+    std::shared_ptr<const GridTopology> grid;
+    ZoneArrays zoneState;
+    FlowPool overloadFlows; // Extra flows towards overloaded houses
+    Rng rng;
+    EventLog eventLog;
+    SimulationStats statistics;
+    LoadProfile* loadProfile;
+
+    double currentTime;
+    uint64_t steps;
+    double lastOverloadEventTime; // Scheduler: time of the last forced overload
+    int promptZone;               // -1 if no house needs a power cut prompt
+
+    // Shedding policy: hysteresis state and the grid demand it arms on
+    bool policyArmed;
+    double lastPolicyTime;
+    float totalMaxLoad;
+    float gridLoadRatio; // Demand over capacity, from the last zone sweep
+    uint64_t topologyHash; // Ties checkpoints to the grid they were taken on
+
+    MpscQueue<SimCommand> commands; // Posted from the UI and other threads, drained at the start of each step
+    std::atomic<uint64_t> commandsDropped;
+
+    FrameArena stepArena; // Scratch for one step (overload candidates), reset when the step ends
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,71 @@
+#include "simulation_thread.h"
+#include <chrono>
+#include "alloc_tracker.h"
+#include "profiler.h"
+
+// Steps allowed in one catch-up burst before the clock is resynchronized.
+// Stops a long stall (debugger, suspended laptop) from freezing the thread.
+static const int MAX_CATCH_UP_STEPS = 250;
+
+SimulationThread::SimulationThread(Simulation& simulation, double stepRate)
+    : simulation(simulation), rate(stepRate), running(false)
+{
+    // Every slot starts out valid so the first acquire() is usable
+    for (int i = 0; i < 3; ++i) {
+        simulation.fillSnapshot(snapshots.slot(i));
+    }
+}
+
+SimulationThread::~SimulationThread()
+{
+    stop();
+}
+
+void SimulationThread::start()
+{
+    if (running.exchange(true)) {
+        return;
+    }
+    thread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop()
+{
+    if (!running.exchange(false)) {
+        return;
+    }
+    thread.join();
+}
+
+void SimulationThread::run()
+{
+    Profiler::setThreadName("Simulation");
+    AllocTracker::setThreadTag(AllocTag::Simulation);
+
+    using clock = std::chrono::steady_clock;
+    const double dt = 1.0 / rate;
+    const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(dt));
+
+    auto nextStep = clock::now();
+    while (running.load(std::memory_order_relaxed)) {
+        auto now = clock::now();
+        int steps = 0;
+        while (nextStep <= now && steps < MAX_CATCH_UP_STEPS) {
+            simulation.step(dt);
+            nextStep += period;
+            ++steps;
+        }
+        if (steps == MAX_CATCH_UP_STEPS) {
+            nextStep = now; // Fell too far behind, drop the backlog
+        }
+
+        if (steps > 0) {
+            simulation.fillSnapshot(snapshots.writeSlot());
+            snapshots.publish();
+            if (onPublish) {
+                onPublish(simulation);
+            }
+        }
+        std::this_thread::sleep_until(nextStep);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef SIMULATION_THREAD_H
+#define SIMULATION_THREAD_H
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "simulation.h"
+#include "triple_buffer.h"
+
+// Runs a Simulation on its own thread at a fixed step rate (default 1 kHz)
+// and publishes a snapshot after every batch of steps. The render thread reads
+// snapshots lock-free, so a slow frame never holds back the simulation clock.
+class SimulationThread
+{
+public:
+    SimulationThread(Simulation& simulation, double stepRate = 1000.0);
+    ~SimulationThread();
+
+    void start();
+    void stop();
+
+    // Render thread only: newest published snapshot
+    const SimSnapshot& latest() { return snapshots.acquire(); }
+
+    double stepRate() const { return rate; }
+
+    // Optional, set before start(): called on the simulation thread after
+    // each published batch (e.g. ControlServer::publish)
+    std::function<void(const Simulation&)> onPublish;
+
+private:
+    void run();
+
+    Simulation& simulation;
+    double rate;
+    std::thread thread;
+    std::atomic<bool> running;
+    TripleBuffer<SimSnapshot> snapshots;
+};
+
+#endif // SIMULATION_THREAD_H
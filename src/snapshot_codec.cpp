@@ -0,0 +1,353 @@
+#include "snapshot_codec.h"
+#include <algorithm>
+#include <cstring>
+#include "profiler.h"
+
+static const uint8_t keyframeFlag = 0x01;
+static const unsigned stateBits = 3;
+static const uint32_t maxQuantizedLoad = 0x7fffffffu; // Differences stay within int32
+
+// --- Bit streams ---
+
+static unsigned BitLength(uint64_t value)
+{
+#if defined(__GNUC__)
+    return value == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned length = 0;
+    while (value != 0) {
+        value >>= 1;
+        ++length;
+    }
+    return length;
+#endif
+}
+
+// LSB-first bit writer appending to a byte vector
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out), bits(0), count(0) {}
+
+    // `width` <= 32; `value` must fit in it
+    void put(uint32_t value, unsigned width)
+    {
+        bits |= static_cast<uint64_t>(value) << count;
+        count += width;
+        if (count >= 32) {
+            uint8_t bytes[4] = { static_cast<uint8_t>(bits), static_cast<uint8_t>(bits >> 8),
+                                 static_cast<uint8_t>(bits >> 16), static_cast<uint8_t>(bits >> 24) };
+            out.insert(out.end(), bytes, bytes + 4);
+            bits >>= 32;
+            count -= 32;
+        }
+    }
+
+    // Exp-Golomb: (length - 1) zeros, a one, then the low (length - 1) bits of value + 1
+    void putUnsigned(uint32_t value)
+    {
+        uint64_t x = static_cast<uint64_t>(value) + 1;
+        unsigned length = BitLength(x);
+        put(0, length - 1);
+        put(1, 1);
+        put(static_cast<uint32_t>(x - (uint64_t(1) << (length - 1))), length - 1);
+    }
+
+    void putSigned(int32_t value)
+    {
+        putUnsigned((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31)); // Zigzag
+    }
+
+    void finish()
+    {
+        while (count > 0) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            count = count > 8 ? count - 8 : 0;
+        }
+        bits = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t bits;
+    unsigned count;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, const uint8_t* end) : data(data), end(end), bits(0), count(0), failed(false) {}
+
+    uint32_t get(unsigned width)
+    {
+        while (count < width && data < end) {
+            bits |= static_cast<uint64_t>(*data++) << count;
+            count += 8;
+        }
+        if (count < width) {
+            failed = true;
+            return 0;
+        }
+        uint32_t value = static_cast<uint32_t>(bits & ((uint64_t(1) << width) - 1));
+        bits >>= width;
+        count -= width;
+        return value;
+    }
+
+    uint32_t getUnsigned()
+    {
+        unsigned zeros = 0;
+        while (!failed && get(1) == 0) {
+            if (++zeros > 32) {
+                failed = true;
+            }
+        }
+        if (failed) {
+            return 0;
+        }
+        uint64_t x = (uint64_t(1) << zeros) | get(zeros);
+        return static_cast<uint32_t>(x - 1);
+    }
+
+    int32_t getSigned()
+    {
+        uint32_t value = getUnsigned();
+        return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+    }
+
+    bool ok() const { return !failed; }
+
+private:
+    const uint8_t* data;
+    const uint8_t* end;
+    uint64_t bits;
+    unsigned count;
+    bool failed;
+};
+
+template <typename T>
+static void Put(std::vector<uint8_t>& out, T value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool Get(const uint8_t*& data, const uint8_t* end, T& value)
+{
+    if (static_cast<size_t>(end - data) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return true;
+}
+
+static uint32_t Quantize(float load, float inverseQuantum)
+{
+    float scaled = load * inverseQuantum + 0.5f;
+    if (!(scaled > 0.0f)) {
+        return 0; // Negative or NaN
+    }
+    return scaled >= static_cast<float>(maxQuantizedLoad) ? maxQuantizedLoad : static_cast<uint32_t>(scaled);
+}
+
+// --- SnapshotEncoder ---
+
+SnapshotEncoder::SnapshotEncoder(SnapshotCodecParams params)
+    : config(params), step(0), time(0.0), framesSinceKey(0), keyframe(false), started(false)
+{
+    if (!(config.loadQuantum > 0.0f)) {
+        config.loadQuantum = SnapshotCodecParams().loadQuantum;
+    }
+}
+
+size_t SnapshotEncoder::encode(const SimSnapshot& snapshot, std::vector<uint8_t>& out)
+{
+    PROFILE_SCOPE("Encode snapshot");
+    const size_t count = snapshot.state.size();
+    const float inverseQuantum = 1.0f / config.loadQuantum;
+    const uint64_t baseStep = step;
+    step = snapshot.step;
+    time = snapshot.time;
+
+    keyframe = !started || count != sentState.size() ||
+               (config.keyframeInterval > 0 && framesSinceKey + 1 >= config.keyframeInterval);
+    started = true;
+    if (keyframe) {
+        sentState.assign(snapshot.state.begin(), snapshot.state.end());
+        sentLoad.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            sentLoad[i] = Quantize(snapshot.currentLoad[i], inverseQuantum);
+        }
+        framesSinceKey = 0;
+        return writeKeyframe(out);
+    }
+    ++framesSinceKey;
+
+    Put<uint8_t>(out, 0);
+    Put<uint64_t>(out, step);
+    Put<double>(out, time);
+    Put<uint64_t>(out, baseStep);
+    Put<uint32_t>(out, static_cast<uint32_t>(count));
+    Put<float>(out, config.loadQuantum);
+    size_t entriesOffset = out.size();
+    Put<uint32_t>(out, 0);
+
+    BitWriter writer(out);
+    uint32_t entries = 0;
+    size_t previous = 0; // One past the last zone written
+    for (size_t i = 0; i < count; ++i) {
+        HouseState state = snapshot.state[i];
+        uint32_t load = Quantize(snapshot.currentLoad[i], inverseQuantum);
+        bool stateChanged = state != sentState[i];
+        if (!stateChanged && load == sentLoad[i]) {
+            continue;
+        }
+        writer.putUnsigned(static_cast<uint32_t>(i - previous));
+        writer.put(stateChanged ? 1 : 0, 1);
+        if (stateChanged) {
+            writer.put(static_cast<uint32_t>(state), stateBits);
+        }
+        writer.putSigned(static_cast<int32_t>(load - sentLoad[i]));
+        sentState[i] = state;
+        sentLoad[i] = load;
+        previous = i + 1;
+        ++entries;
+    }
+    writer.finish();
+    std::memcpy(&out[entriesOffset], &entries, sizeof(entries));
+    return entries;
+}
+
+bool SnapshotEncoder::appendKeyframe(std::vector<uint8_t>& out) const
+{
+    if (!started) {
+        return false;
+    }
+    writeKeyframe(out);
+    return true;
+}
+
+size_t SnapshotEncoder::writeKeyframe(std::vector<uint8_t>& out) const
+{
+    const uint32_t count = static_cast<uint32_t>(sentState.size());
+    uint32_t largest = 0;
+    for (uint32_t load : sentLoad) {
+        largest = std::max(largest, load);
+    }
+    const unsigned loadBits = BitLength(largest);
+
+    Put<uint8_t>(out, keyframeFlag);
+    Put<uint64_t>(out, step);
+    Put<double>(out, time);
+    Put<uint32_t>(out, count);
+    Put<float>(out, config.loadQuantum);
+    Put<uint32_t>(out, count);
+    Put<uint8_t>(out, static_cast<uint8_t>(loadBits));
+
+    out.reserve(out.size() + (static_cast<size_t>(count) * (stateBits + loadBits) + 7) / 8 + 4);
+    BitWriter writer(out);
+    for (uint32_t i = 0; i < count; ++i) {
+        writer.put(static_cast<uint32_t>(sentState[i]), stateBits);
+        writer.put(sentLoad[i], loadBits);
+    }
+    writer.finish();
+    return count;
+}
+
+// --- SnapshotDecoder ---
+
+SnapshotDecoder::SnapshotDecoder() : hasKeyframe(false), currentStep(0), currentTime(0.0), loadQuantum(0.0f)
+{
+}
+
+bool SnapshotDecoder::apply(const uint8_t* frame, size_t size)
+{
+    const uint8_t* data = frame;
+    const uint8_t* end = frame + size;
+    uint8_t flags;
+    uint64_t frameStep, baseStep = 0;
+    double frameTime;
+    uint32_t count, entries;
+    float quantum;
+    if (!Get(data, end, flags) || !Get(data, end, frameStep) || !Get(data, end, frameTime)) {
+        return false;
+    }
+    const bool key = (flags & keyframeFlag) != 0;
+    if (!key && !Get(data, end, baseStep)) {
+        return false;
+    }
+    if (!Get(data, end, count) || !Get(data, end, quantum) || !Get(data, end, entries)) {
+        return false;
+    }
+
+    if (key) {
+        uint8_t loadBits;
+        if (!Get(data, end, loadBits) || loadBits > 31 || entries != count) {
+            return false;
+        }
+        BitReader reader(data, end);
+        std::vector<HouseState> states(count);
+        std::vector<uint32_t> loads(count);
+        for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+            uint32_t state = reader.get(stateBits);
+            states[i] = static_cast<HouseState>(state);
+            loads[i] = reader.get(loadBits);
+            if (state > COOLDOWN) {
+                return false;
+            }
+        }
+        if (!reader.ok()) {
+            return false;
+        }
+        zoneState.swap(states);
+        quantizedLoad.swap(loads);
+        zoneLoad.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            zoneLoad[i] = static_cast<float>(quantizedLoad[i]) * quantum;
+        }
+        loadQuantum = quantum;
+        hasKeyframe = true;
+    } else {
+        if (!hasKeyframe || baseStep != currentStep || count != zoneState.size() || quantum != loadQuantum ||
+            entries > count) {
+            return false;
+        }
+        // Check the whole delta before touching any zone
+        struct Entry {
+            uint32_t zone;
+            int32_t state; // -1: unchanged
+            int32_t loadChange;
+        };
+        std::vector<Entry> changes(entries);
+        BitReader reader(data, end);
+        uint64_t zone = 0;
+        for (uint32_t e = 0; e < entries && reader.ok(); ++e) {
+            zone += reader.getUnsigned();
+            Entry& change = changes[e];
+            change.zone = static_cast<uint32_t>(zone);
+            change.state = reader.get(1) ? static_cast<int32_t>(reader.get(stateBits)) : -1;
+            change.loadChange = reader.getSigned();
+            if (zone >= count || change.state > COOLDOWN) {
+                return false;
+            }
+            ++zone;
+        }
+        if (!reader.ok()) {
+            return false;
+        }
+        for (const Entry& change : changes) {
+            if (change.state >= 0) {
+                zoneState[change.zone] = static_cast<HouseState>(change.state);
+            }
+            quantizedLoad[change.zone] += static_cast<uint32_t>(change.loadChange);
+            zoneLoad[change.zone] = static_cast<float>(quantizedLoad[change.zone]) * quantum;
+        }
+    }
+
+    currentStep = frameStep;
+    currentTime = frameTime;
+    return true;
+}
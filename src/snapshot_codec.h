@@ -0,0 +1,94 @@
+#ifndef SNAPSHOT_CODEC_H
+#define SNAPSHOT_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "simulation.h"
+
+// Compact telemetry stream of zone states and loads, one frame per published
+// step. Loads are quantized to multiples of `loadQuantum`; a frame is either
+//  * a keyframe: every zone, or
+//  * a delta against the previous frame: only the zones whose state or
+//    quantized load changed.
+// Every keyframeInterval-th frame is a keyframe, so a consumer that joins late
+// or lost frames is back in sync within one interval.
+//
+// Frame layout (little-endian, no padding):
+//
+//   uint8  flags       bit 0: keyframe
+//   uint64 step, double time
+//   uint64 baseStep    delta only: the step this frame applies on top of
+//   uint32 zoneCount, float loadQuantum
+//   uint32 entries     zones in the bit stream below
+//   uint8  loadBits    keyframe only: width of each quantized load
+//   ...    bit stream, LSB first, padded to a whole byte
+//
+// Keyframe entry: 3-bit state, loadBits-bit quantized load.
+// Delta entry:    gap to the previous entry's zone minus one (Exp-Golomb),
+//                 1 bit "state changed" (+ 3-bit state), quantized load change
+//                 (zigzag Exp-Golomb).
+// On a grid where few zones move per tick a delta is a few bytes per changed
+// zone instead of 5 bytes for every zone.
+
+struct SnapshotCodecParams {
+    float loadQuantum = 1.0f / 1024.0f;
+    uint32_t keyframeInterval = 1000; // Frames; 1: every frame, 0: only the first
+};
+
+class SnapshotEncoder
+{
+public:
+    explicit SnapshotEncoder(SnapshotCodecParams params = SnapshotCodecParams());
+
+    // Append the frame for `snapshot` to `out`: a delta against the previous
+    // encode(), or a keyframe (on schedule, on the first call, or when the
+    // zone count changed). Returns the zones written.
+    size_t encode(const SimSnapshot& snapshot, std::vector<uint8_t>& out);
+
+    // Append a keyframe of the last encoded frame (for a consumer that joins
+    // now); following deltas apply on top of it. False before the first encode().
+    bool appendKeyframe(std::vector<uint8_t>& out) const;
+
+    bool lastWasKeyframe() const { return keyframe; }
+    const SnapshotCodecParams& params() const { return config; }
+
+private:
+    size_t writeKeyframe(std::vector<uint8_t>& out) const;
+
+    SnapshotCodecParams config;
+    uint64_t step;
+    double time;
+    uint32_t framesSinceKey;
+    bool keyframe;
+    bool started;
+    std::vector<HouseState> sentState; // What a synced decoder holds
+    std::vector<uint32_t> sentLoad;    // Quantized
+};
+
+class SnapshotDecoder
+{
+public:
+    SnapshotDecoder();
+
+    // Apply one frame. False (state unchanged) for a malformed frame or a delta
+    // that does not follow the last applied frame; wait for a keyframe then.
+    bool apply(const uint8_t* frame, size_t size);
+
+    bool synced() const { return hasKeyframe; }
+    uint64_t step() const { return currentStep; }
+    double time() const { return currentTime; }
+    const std::vector<HouseState>& state() const { return zoneState; }
+    const std::vector<float>& load() const { return zoneLoad; }
+
+private:
+    bool hasKeyframe;
+    uint64_t currentStep;
+    double currentTime;
+    float loadQuantum;
+    std::vector<HouseState> zoneState;
+    std::vector<uint32_t> quantizedLoad;
+    std::vector<float> zoneLoad;
+};
+
+#endif // SNAPSHOT_CODEC_H
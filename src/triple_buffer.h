@@ -0,0 +1,50 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer.
+// The producer fills writeSlot() and publish()es it; the consumer acquire()s
+// the most recently published slot. Neither side ever waits for the other, and
+// a slot is never written while the consumer is reading it.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+
+    // Producer side
+    T& writeSlot() { return slots[writeIndex]; }
+
+    void publish()
+    {
+        // Hand the written slot to the middle and take back whatever was there
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(writeIndex | FRESH_BIT), std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Consumer side. Returns the newest published value (or the last one again).
+    const T& acquire()
+    {
+        if (middle.load(std::memory_order_relaxed) & FRESH_BIT) {
+            uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX_MASK;
+        }
+        return slots[readIndex];
+    }
+
+    // Direct access for one-time initialization before the producer starts
+    T& slot(int i) { return slots[i]; }
+
+private:
+    static const uint8_t FRESH_BIT = 0x4;
+    static const uint8_t INDEX_MASK = 0x3;
+
+    T slots[3];
+    std::atomic<uint8_t> middle; // Index of the spare slot, FRESH_BIT if unread
+    int writeIndex; // Owned by the producer
+    int readIndex;  // Owned by the consumer
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -0,0 +1,136 @@
+#include "vertex_layout.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+GLsizei VertexLayout::positionSize() const
+{
+    switch (position) {
+        case PositionFormat::Float32x3: return 3 * sizeof(float);
+        case PositionFormat::Float32x2: return 2 * sizeof(float);
+        case PositionFormat::Float16x2: return 2 * sizeof(uint16_t);
+        case PositionFormat::Snorm16x2: return 2 * sizeof(int16_t);
+    }
+    return 0;
+}
+
+GLsizei VertexLayout::stride() const
+{
+    return positionSize() + (vertexColor ? 4 : 0);
+}
+
+void VertexLayout::apply() const
+{
+    const GLsizei vertexStride = stride();
+    switch (position) {
+        case PositionFormat::Float32x3:
+            glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE, vertexStride, (void*)0);
+            break;
+        case PositionFormat::Float32x2:
+            glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, vertexStride, (void*)0);
+            break;
+        case PositionFormat::Float16x2:
+            glVertexAttribPointer(positionAttribute, 2, GL_HALF_FLOAT, GL_FALSE, vertexStride, (void*)0);
+            break;
+        case PositionFormat::Snorm16x2:
+            glVertexAttribPointer(positionAttribute, 2, GL_SHORT, GL_TRUE, vertexStride, (void*)0);
+            break;
+    }
+    glEnableVertexAttribArray(positionAttribute);
+
+    if (vertexColor) {
+        glVertexAttribPointer(colorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, vertexStride, (void*)(size_t)positionSize());
+        glEnableVertexAttribArray(colorAttribute);
+    } else {
+        glDisableVertexAttribArray(colorAttribute);
+    }
+}
+
+PackedVertices PackVertices(const std::vector<float>& positions,
+                            const std::vector<float>& colors,
+                            const VertexLayout& layout)
+{
+    PackedVertices packed;
+    packed.vertexCount = positions.size() / 3;
+
+    if (layout.position == PositionFormat::Snorm16x2) {
+        float extent = 0.0f;
+        for (size_t v = 0; v < packed.vertexCount; ++v) {
+            extent = std::max(extent, std::max(std::fabs(positions[v * 3]), std::fabs(positions[v * 3 + 1])));
+        }
+        packed.positionScale = extent > 0.0f ? extent : 1.0f;
+    }
+    const float inverseScale = 1.0f / packed.positionScale;
+
+    const size_t stride = layout.stride();
+    packed.bytes.resize(packed.vertexCount * stride);
+    for (size_t v = 0; v < packed.vertexCount; ++v) {
+        uint8_t* out = packed.bytes.data() + v * stride;
+        const float* p = &positions[v * 3];
+        switch (layout.position) {
+            case PositionFormat::Float32x3:
+                std::memcpy(out, p, 3 * sizeof(float));
+                break;
+            case PositionFormat::Float32x2:
+                std::memcpy(out, p, 2 * sizeof(float));
+                break;
+            case PositionFormat::Float16x2: {
+                uint16_t half[2] = { glm::packHalf1x16(p[0]), glm::packHalf1x16(p[1]) };
+                std::memcpy(out, half, sizeof(half));
+                break;
+            }
+            case PositionFormat::Snorm16x2: {
+                uint16_t snorm[2] = { glm::packSnorm1x16(p[0] * inverseScale), glm::packSnorm1x16(p[1] * inverseScale) };
+                std::memcpy(out, snorm, sizeof(snorm));
+                break;
+            }
+        }
+        if (layout.vertexColor) {
+            uint8_t* rgba = out + layout.positionSize();
+            for (int c = 0; c < 3; ++c) {
+                float value = v * 3 + c < colors.size() ? colors[v * 3 + c] : 1.0f; // Missing colors default to white
+                rgba[c] = static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+            }
+            rgba[3] = 255;
+        }
+    }
+    return packed;
+}
+
+template <typename T>
+static void narrowIndices(const std::vector<GLuint>& indices, std::vector<uint8_t>& bytes)
+{
+    bytes.resize(indices.size() * sizeof(T));
+    T* out = reinterpret_cast<T*>(bytes.data());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        out[i] = static_cast<T>(indices[i]);
+    }
+}
+
+PackedIndices PackIndices(const std::vector<GLuint>& indices)
+{
+    PackedIndices packed;
+    packed.count = indices.size();
+    GLuint maxIndex = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+    if (maxIndex <= 0xFF) {
+        packed.type = GL_UNSIGNED_BYTE;
+        narrowIndices<uint8_t>(indices, packed.bytes);
+    } else if (maxIndex <= 0xFFFF) {
+        packed.type = GL_UNSIGNED_SHORT;
+        narrowIndices<uint16_t>(indices, packed.bytes);
+    } else {
+        packed.type = GL_UNSIGNED_INT;
+        narrowIndices<uint32_t>(indices, packed.bytes);
+    }
+    return packed;
+}
+
+size_t IndexTypeSize(GLenum type)
+{
+    switch (type) {
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        default: return 4;
+    }
+}
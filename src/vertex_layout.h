@@ -0,0 +1,57 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+
+// Vertex and index storage formats for meshes.
+// Meshes are authored as xyz floats (+ optional rgb floats per vertex) and
+// packed into the layout's format on upload. The scene is 2D, so the compact
+// formats drop Z (the shader sees z = 0). Snorm16 positions are divided by the
+// mesh's largest coordinate first; that factor comes back as positionScale
+// and must be folded into the draw scale.
+
+enum class PositionFormat : uint8_t {
+    Float32x3, // 12 bytes, unrestricted
+    Float32x2, // 8 bytes, z dropped
+    Float16x2, // 4 bytes, z dropped, ~3 significant digits
+    Snorm16x2  // 4 bytes, z dropped, 1/32767 of the mesh extent
+};
+
+struct VertexLayout {
+    PositionFormat position = PositionFormat::Float32x3;
+    bool vertexColor = false; // RGBA8 color at attribute 1 (otherwise attribute 1 is constant white)
+
+    static constexpr GLuint positionAttribute = 0;
+    static constexpr GLuint colorAttribute = 1;
+
+    GLsizei positionSize() const; // Bytes of the position attribute
+    GLsizei stride() const;
+
+    // Set up the attribute pointers for the currently bound VAO/VBO
+    void apply() const;
+};
+
+// Interleaved vertex bytes in `layout`. `colors` is rgb per vertex (or empty)
+struct PackedVertices {
+    std::vector<uint8_t> bytes;
+    float positionScale = 1.0f;
+    size_t vertexCount = 0;
+};
+PackedVertices PackVertices(const std::vector<float>& positions,
+                            const std::vector<float>& colors,
+                            const VertexLayout& layout);
+
+// Indices narrowed to the smallest type that holds the largest index
+struct PackedIndices {
+    std::vector<uint8_t> bytes;
+    GLenum type = GL_UNSIGNED_INT; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    size_t count = 0;
+};
+PackedIndices PackIndices(const std::vector<GLuint>& indices);
+
+size_t IndexTypeSize(GLenum type);
+
+#endif // VERTEX_LAYOUT_H
@@ -0,0 +1,68 @@
+#include "worker_pool.h"
+#include <algorithm>
+#include "profiler.h"
+
+WorkerPool::WorkerPool(unsigned threadCount)
+    : outstanding(0), stopping(false)
+{
+    if (threadCount == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        threadCount = std::max(1u, hardware > 1 ? hardware - 1 : 1u);
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+        ++outstanding;
+    }
+    taskAvailable.notify_one();
+}
+
+void WorkerPool::waitBelow(size_t limit)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    taskFinished.wait(lock, [&] { return outstanding < limit; });
+}
+
+void WorkerPool::run()
+{
+    Profiler::setThreadName("Worker");
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [&] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // Stopping and nothing left to do
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --outstanding;
+        }
+        taskFinished.notify_all();
+    }
+}
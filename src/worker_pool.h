@@ -0,0 +1,41 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool with a FIFO task queue
+class WorkerPool
+{
+public:
+    // 0 threads = one per hardware thread, minus the caller's
+    explicit WorkerPool(unsigned threadCount = 0);
+    ~WorkerPool();
+
+    void submit(std::function<void()> task);
+
+    // Block until fewer than `limit` tasks are queued or running (backpressure)
+    void waitBelow(size_t limit);
+
+    // Block until every submitted task has finished
+    void waitIdle() { waitBelow(1); }
+
+    size_t threadCount() const { return workers.size(); }
+
+private:
+    void run();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable taskFinished;
+    size_t outstanding; // Queued + running
+    bool stopping;
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,176 @@
+#include "zone_picker.h"
+#include <algorithm>
+#include <cmath>
+#include "profiler.h"
+
+static bool Contains(const ZoneBox& box, glm::vec2 point)
+{
+    return point.x >= box.min.x && point.x <= box.max.x && point.y >= box.min.y && point.y <= box.max.y;
+}
+
+static bool Overlaps(const ZoneBox& a, const ZoneBox& b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+// --- ZonePicker ---
+
+ZonePicker::ZonePicker(const GridTopology& topology)
+    : origin(0.0f), inverseCellSize(1.0f), columns(1), rows(1)
+{
+    PROFILE_SCOPE("Build zone picker");
+    const size_t count = topology.zoneCount();
+    boxes.resize(count);
+    ZoneBox bounds = { glm::vec2(0.0f), glm::vec2(0.0f) };
+    float largest = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        boxes[i] = topology.zoneBounds(i);
+        bounds.min = i == 0 ? boxes[i].min : glm::min(bounds.min, boxes[i].min);
+        bounds.max = i == 0 ? boxes[i].max : glm::max(bounds.max, boxes[i].max);
+        largest = std::max(largest, std::max(boxes[i].max.x - boxes[i].min.x, boxes[i].max.y - boxes[i].min.y));
+    }
+
+    // About one zone per cell, but never cells smaller than a house, so a
+    // house overlaps at most four of them
+    if (count > 0) {
+        glm::vec2 extent = glm::max(bounds.max - bounds.min, glm::vec2(1e-6f));
+        float cellSize = std::max(largest, std::sqrt(extent.x * extent.y / static_cast<float>(count)));
+        cellSize = std::max(cellSize, 1e-6f);
+        columns = std::max(1, static_cast<int>(std::ceil(extent.x / cellSize)));
+        rows = std::max(1, static_cast<int>(std::ceil(extent.y / cellSize)));
+        origin = bounds.min;
+        inverseCellSize = glm::vec2(columns / extent.x, rows / extent.y);
+    }
+
+    // Count, prefix sum, fill
+    cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        for (int y = cellY(boxes[i].min.y); y <= cellY(boxes[i].max.y); ++y) {
+            for (int x = cellX(boxes[i].min.x); x <= cellX(boxes[i].max.x); ++x) {
+                ++cellStart[static_cast<size_t>(y) * columns + x + 1];
+            }
+        }
+    }
+    for (size_t c = 1; c < cellStart.size(); ++c) {
+        cellStart[c] += cellStart[c - 1];
+    }
+    cellZones.resize(cellStart.back());
+    std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        for (int y = cellY(boxes[i].min.y); y <= cellY(boxes[i].max.y); ++y) {
+            for (int x = cellX(boxes[i].min.x); x <= cellX(boxes[i].max.x); ++x) {
+                cellZones[fill[static_cast<size_t>(y) * columns + x]++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+}
+
+int ZonePicker::cellX(float x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - origin.x) * inverseCellSize.x)), 0, columns - 1);
+}
+
+int ZonePicker::cellY(float y) const
+{
+    return std::clamp(static_cast<int>(std::floor((y - origin.y) * inverseCellSize.y)), 0, rows - 1);
+}
+
+int ZonePicker::pick(glm::vec2 point) const
+{
+    if (boxes.empty()) {
+        return -1;
+    }
+    const size_t cell = static_cast<size_t>(cellY(point.y)) * columns + cellX(point.x);
+    int found = -1;
+    for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+        uint32_t zone = cellZones[k];
+        if (static_cast<int>(zone) > found && Contains(boxes[zone], point)) {
+            found = static_cast<int>(zone); // Later houses are drawn on top
+        }
+    }
+    return found;
+}
+
+void ZonePicker::query(const ZoneBox& box, std::vector<int>& out) const
+{
+    if (boxes.empty()) {
+        return;
+    }
+    const int x0 = cellX(box.min.x), x1 = cellX(box.max.x);
+    const int y0 = cellY(box.min.y), y1 = cellY(box.max.y);
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const size_t cell = static_cast<size_t>(y) * columns + x;
+            for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                uint32_t zone = cellZones[k];
+                const ZoneBox& zoneBox = boxes[zone];
+                if (!Overlaps(zoneBox, box)) {
+                    continue;
+                }
+                // A house in several cells is reported from the first of them inside the query
+                if (std::max(cellX(zoneBox.min.x), x0) == x && std::max(cellY(zoneBox.min.y), y0) == y) {
+                    out.push_back(static_cast<int>(zone));
+                }
+            }
+        }
+    }
+}
+
+// --- ZoneSelection ---
+
+ZoneSelection::ZoneSelection(size_t zoneCount) : position(zoneCount, none)
+{
+}
+
+void ZoneSelection::add(int zone)
+{
+    if (position[zone] == none) {
+        position[zone] = static_cast<uint32_t>(zones.size());
+        zones.push_back(zone);
+        ++changes;
+    }
+}
+
+void ZoneSelection::remove(int zone)
+{
+    uint32_t index = position[zone];
+    if (index == none) {
+        return;
+    }
+    // Swap with the last entry
+    int last = zones.back();
+    zones[index] = last;
+    position[last] = index;
+    zones.pop_back();
+    position[zone] = none;
+    ++changes;
+}
+
+void ZoneSelection::toggle(int zone)
+{
+    if (contains(zone)) {
+        remove(zone);
+    } else {
+        add(zone);
+    }
+}
+
+void ZoneSelection::clear()
+{
+    for (int zone : zones) {
+        position[zone] = none;
+    }
+    zones.clear();
+    ++changes;
+}
+
+void ZoneSelection::selectAll()
+{
+    clear();
+    zones.reserve(position.size());
+    for (size_t i = 0; i < position.size(); ++i) {
+        position[i] = static_cast<uint32_t>(i);
+        zones.push_back(static_cast<int>(i));
+    }
+    ++changes;
+}
@@ -0,0 +1,69 @@
+#ifndef ZONE_PICKER_H
+#define ZONE_PICKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "simulation.h"
+
+// Spatial index over the zone boxes (GridTopology::zoneBounds) for mouse
+// picking in the viewport. A uniform grid over the scene bounds, sized for
+// about one zone per cell; each cell lists the zones whose box overlaps it
+// (CSR: one offsets array, one flat zone array, built once from the
+// immutable topology). A point lookup scans one cell, so hover and click stay
+// constant time at 1M zones; a box query touches only the cells it covers.
+class ZonePicker
+{
+public:
+    explicit ZonePicker(const GridTopology& topology);
+
+    // Zone under `point` (scene coordinates), the last drawn one where
+    // houses overlap; -1 if none
+    int pick(glm::vec2 point) const;
+
+    // Append every zone whose box overlaps `box` to `out`, each once
+    void query(const ZoneBox& box, std::vector<int>& out) const;
+
+    size_t cellCount() const { return cellStart.size() - 1; }
+
+private:
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+    std::vector<ZoneBox> boxes;
+    glm::vec2 origin;
+    glm::vec2 inverseCellSize;
+    int columns;
+    int rows;
+    std::vector<uint32_t> cellStart; // Zones of cell c: cellZones[cellStart[c], cellStart[c + 1])
+    std::vector<uint32_t> cellZones;
+};
+
+// Set of selected zones: O(1) add/remove/contains, plus a dense list to
+// iterate. Drives the controls panel instead of a list of every house.
+class ZoneSelection
+{
+public:
+    explicit ZoneSelection(size_t zoneCount);
+
+    bool contains(int zone) const { return position[zone] != none; }
+    void add(int zone);
+    void remove(int zone);
+    void toggle(int zone);
+    void clear();
+    void selectAll();
+
+    size_t size() const { return zones.size(); }
+    bool empty() const { return zones.empty(); }
+    const std::vector<int>& list() const { return zones; } // Dense; removals swap the last entry in
+    uint64_t version() const { return changes; } // Moves on with every change, for cached views
+
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+    std::vector<uint32_t> position; // Index into `zones`, none if not selected
+    std::vector<int> zones;
+    uint64_t changes = 0;
+};
+
+#endif // ZONE_PICKER_H
@@ -0,0 +1,122 @@
+#include "zone_table.h"
+#include <algorithm>
+#include "profiler.h"
+
+enum ZoneColumn : ImGuiID {
+    ColumnName,
+    ColumnLoad,
+    ColumnState,
+    ColumnAction
+};
+
+ImVec4 StateTextColor(HouseState state)
+{
+    switch (state) {
+        case NORMAL: return ImVec4(0.0f, 1.0f, 0.0f, 1.0f); // Green
+        case WARNING: return ImVec4(1.0f, 1.0f, 0.0f, 1.0f); // Yellow
+        case OVERLOADED: return ImVec4(1.0f, 0.0f, 0.0f, 1.0f); // Red
+        case POWER_CUT: return ImVec4(0.5f, 0.5f, 0.5f, 1.0f); // Dark Gray
+        case COOLDOWN: return ImVec4(0.7f, 0.7f, 0.7f, 1.0f); // Light Gray
+    }
+    return ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void ZoneTable::sortRows(const GridTopology& topology, const SimSnapshot& snapshot, const ImGuiTableSortSpecs* specs)
+{
+    PROFILE_SCOPE("Sort zone table");
+    liveSort = false;
+    if (!specs || specs->SpecsCount == 0) {
+        return; // Selection order
+    }
+    for (int s = 0; s < specs->SpecsCount; ++s) {
+        ImGuiID column = specs->Specs[s].ColumnUserID;
+        liveSort = liveSort || column == ColumnLoad || column == ColumnState;
+    }
+
+    std::sort(rows.begin(), rows.end(), [&](int a, int b) {
+        for (int s = 0; s < specs->SpecsCount; ++s) {
+            const ImGuiTableColumnSortSpecs& spec = specs->Specs[s];
+            int order = 0;
+            switch (spec.ColumnUserID) {
+                case ColumnName:
+                    order = topology.zoneNames[a].compare(topology.zoneNames[b]);
+                    break;
+                case ColumnLoad: {
+                    float loadA = snapshot.currentLoad[a], loadB = snapshot.currentLoad[b];
+                    order = loadA < loadB ? -1 : (loadA > loadB ? 1 : 0);
+                    break;
+                }
+                case ColumnState:
+                    order = static_cast<int>(snapshot.state[a]) - static_cast<int>(snapshot.state[b]);
+                    break;
+            }
+            if (order != 0) {
+                return spec.SortDirection == ImGuiSortDirection_Descending ? order > 0 : order < 0;
+            }
+        }
+        return a < b; // Stable order between equal rows
+    });
+}
+
+void ZoneTable::draw(const GridTopology& topology, const SimSnapshot& snapshot, const ZoneSelection& selection,
+                     Simulation& simulation)
+{
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_ScrollY |
+                                  ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV |
+                                  ImGuiTableFlags_Resizable;
+    // Shrink to the rows for small selections; scroll past `height`
+    float tableHeight = std::min(height, ImGui::GetTextLineHeightWithSpacing() * (static_cast<float>(selection.size()) + 2.0f));
+    if (!ImGui::BeginTable("zones", 4, flags, ImVec2(0.0f, tableHeight))) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1); // Header stays visible
+    ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_DefaultSort, 0.0f, ColumnName);
+    ImGui::TableSetupColumn("Load", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, ColumnLoad);
+    ImGui::TableSetupColumn("State", 0, 0.0f, ColumnState);
+    ImGui::TableSetupColumn("Action", ImGuiTableColumnFlags_NoSort, 0.0f, ColumnAction);
+    ImGui::TableHeadersRow();
+
+    ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+    bool selectionChanged = selection.version() != selectionVersion;
+    if (selectionChanged || (specs && specs->SpecsDirty) ||
+        (liveSort && ImGui::GetTime() - lastSortTime >= refreshInterval)) {
+        if (selectionChanged) {
+            rows.assign(selection.list().begin(), selection.list().end()); // Reuses the capacity
+        }
+        sortRows(topology, snapshot, specs);
+        if (specs) {
+            specs->SpecsDirty = false;
+        }
+        selectionVersion = selection.version();
+        lastSortTime = ImGui::GetTime();
+    }
+
+    // Only the visible rows are built
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rows.size()));
+    while (clipper.Step()) {
+        for (int r = clipper.DisplayStart; r < clipper.DisplayEnd; ++r) {
+            const int zone = rows[r];
+            const HouseState state = snapshot.state[zone];
+            ImGui::TableNextRow();
+            ImGui::PushID(zone); // Unique ID for each house's widgets
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(topology.zoneNames[zone].c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f%%", snapshot.currentLoad[zone] * 100.0f);
+            ImGui::TableNextColumn();
+            ImGui::TextColored(StateTextColor(state), "%s", HouseStateName(state));
+            ImGui::TableNextColumn();
+            // Small buttons keep every row one text line high, as the clipper expects
+            if (state == OVERLOADED && ImGui::SmallButton("Manual Shed")) {
+                simulation.postCommand({SimCommandType::ManualShed, zone});
+            } else if (state == POWER_CUT || state == COOLDOWN) {
+                ImGui::TextDisabled("Power Off"); // Indicate power is off
+            }
+
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndTable();
+}
@@ -0,0 +1,37 @@
+#ifndef ZONE_TABLE_H
+#define ZONE_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include "imgui.h"
+#include "simulation.h"
+#include "zone_picker.h"
+
+ImVec4 StateTextColor(HouseState state);
+
+// Zone table of the controls panel: one row per selected house with its
+// name, load, state and actions. Rows go through ImGuiListClipper, so only
+// the visible ones are built, and the table sorts by name, load or state
+// (Shift+click sorts by several). The sorted row order is cached and only
+// rebuilt when the sort specs or the selection change, or every
+// refreshInterval seconds while a live column (load, state) is sorted, so a
+// 100k-row table costs about as much per frame as a 20-row one.
+class ZoneTable
+{
+public:
+    float refreshInterval = 0.5f; // Seconds between re-sorts on live columns
+    float height = 320.0f;        // Visible rows scroll inside this
+
+    void draw(const GridTopology& topology, const SimSnapshot& snapshot, const ZoneSelection& selection,
+              Simulation& simulation);
+
+private:
+    void sortRows(const GridTopology& topology, const SimSnapshot& snapshot, const ImGuiTableSortSpecs* specs);
+
+    std::vector<int> rows; // Zones in display order
+    uint64_t selectionVersion = UINT64_MAX;
+    double lastSortTime = 0.0;
+    bool liveSort = false; // Sorted by a column that changes every step
+};
+
+#endif // ZONE_TABLE_H
@@ -0,0 +1,311 @@
+// Capture encoders (image_encoders.h) against decoders written from the
+// format specs: QOI and PNG must give back the exact pixels, Y4M the BT.601
+// full-range planes to within rounding.
+#include "image_encoders.h"
+#include "test_check.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Bottom-up RGBA8, as glReadPixels returns it
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgba;
+
+    Image(int width, int height) : width(width), height(height), rgba(static_cast<size_t>(width) * height * 4, 255) {}
+
+    uint8_t* at(int x, int yTop) { return &rgba[(static_cast<size_t>(height - 1 - yTop) * width + x) * 4]; }
+    const uint8_t* at(int x, int yTop) const { return &rgba[(static_cast<size_t>(height - 1 - yTop) * width + x) * 4]; }
+
+    void set(int x, int yTop, uint8_t r, uint8_t g, uint8_t b)
+    {
+        uint8_t* px = at(x, yTop);
+        px[0] = r; px[1] = g; px[2] = b;
+    }
+
+    // Top-down RGB, what the decoders return
+    std::vector<uint8_t> rgb() const
+    {
+        std::vector<uint8_t> result;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                result.insert(result.end(), at(x, y), at(x, y) + 3);
+            }
+        }
+        return result;
+    }
+};
+
+// Flat runs, small steps, large jumps and repeats of earlier colours, so
+// every QOI op shows up
+static Image MakeImage(int width, int height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    Image image(width, height);
+    uint8_t r = 0, g = 0, b = 0;
+    std::vector<uint8_t> palette = { 0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 255, 0 };
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            switch (rng() % 6) {
+                case 0: break; // Repeat
+                case 1: r = static_cast<uint8_t>(r + rng() % 3 - 1); g = static_cast<uint8_t>(g + rng() % 3 - 1); break;
+                case 2: g = static_cast<uint8_t>(g + rng() % 40 - 20); r = static_cast<uint8_t>(g + rng() % 9 - 4); break;
+                case 3: r = static_cast<uint8_t>(rng()); g = static_cast<uint8_t>(rng()); b = static_cast<uint8_t>(rng()); break;
+                default: {
+                    size_t entry = rng() % (palette.size() / 3) * 3;
+                    r = palette[entry]; g = palette[entry + 1]; b = palette[entry + 2];
+                    break;
+                }
+            }
+            image.set(x, y, r, g, b);
+        }
+    }
+    return image;
+}
+
+static uint32_t GetBE32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+// --- QOI ---
+
+static bool DecodeQOI(const std::vector<uint8_t>& data, int& width, int& height, std::vector<uint8_t>& rgb)
+{
+    if (data.size() < 22 || std::memcmp(data.data(), "qoif", 4) != 0 || data[12] != 3 ||
+        std::memcmp(&data[data.size() - 8], "\0\0\0\0\0\0\0\1", 8) != 0) {
+        return false;
+    }
+    width = static_cast<int>(GetBE32(&data[4]));
+    height = static_cast<int>(GetBE32(&data[8]));
+    const size_t pixels = static_cast<size_t>(width) * height;
+    const size_t end = data.size() - 8;
+
+    uint8_t index[64][4] = {};
+    uint8_t px[4] = { 0, 0, 0, 255 };
+    size_t p = 14;
+    rgb.clear();
+    while (rgb.size() < pixels * 3) {
+        if (p >= end) {
+            return false;
+        }
+        uint8_t op = data[p++];
+        int run = 1;
+        if (op == 0xfe) {
+            if (p + 3 > end) return false;
+            px[0] = data[p]; px[1] = data[p + 1]; px[2] = data[p + 2];
+            p += 3;
+        } else if (op == 0xff) {
+            if (p + 4 > end) return false;
+            std::memcpy(px, &data[p], 4);
+            p += 4;
+        } else if ((op & 0xc0) == 0x00) {
+            std::memcpy(px, index[op], 4);
+        } else if ((op & 0xc0) == 0x40) {
+            px[0] = static_cast<uint8_t>(px[0] + ((op >> 4) & 3) - 2);
+            px[1] = static_cast<uint8_t>(px[1] + ((op >> 2) & 3) - 2);
+            px[2] = static_cast<uint8_t>(px[2] + (op & 3) - 2);
+        } else if ((op & 0xc0) == 0x80) {
+            if (p + 1 > end) return false;
+            int dg = (op & 0x3f) - 32;
+            uint8_t second = data[p++];
+            px[0] = static_cast<uint8_t>(px[0] + dg - 8 + (second >> 4));
+            px[1] = static_cast<uint8_t>(px[1] + dg);
+            px[2] = static_cast<uint8_t>(px[2] + dg - 8 + (second & 0x0f));
+        } else {
+            run = (op & 0x3f) + 1;
+        }
+        std::memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+        for (int i = 0; i < run; ++i) {
+            rgb.insert(rgb.end(), px, px + 3);
+        }
+    }
+    return rgb.size() == pixels * 3 && p == end;
+}
+
+static bool QOIRoundTrips(const Image& image)
+{
+    std::vector<uint8_t> encoded;
+    EncodeQOI(image.rgba.data(), image.width, image.height, encoded);
+    int width = 0, height = 0;
+    std::vector<uint8_t> rgb;
+    return DecodeQOI(encoded, width, height, rgb) && width == image.width && height == image.height && rgb == image.rgb();
+}
+
+static void TestQOI()
+{
+    // Black that does not start the image must not hit the zeroed index slot
+    Image colours(5, 1);
+    colours.set(0, 0, 255, 0, 0);
+    colours.set(1, 0, 0, 0, 0);
+    colours.set(2, 0, 0, 255, 0);
+    colours.set(3, 0, 0, 0, 255);
+    colours.set(4, 0, 0, 255, 0);
+    CHECK(QOIRoundTrips(colours));
+
+    Image black(70, 3); // Runs longer than 62, starting on the initial pixel
+    for (int y = 0; y < black.height; ++y) {
+        for (int x = 0; x < black.width; ++x) {
+            black.set(x, y, 0, 0, 0);
+        }
+    }
+    CHECK(QOIRoundTrips(black));
+
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        CHECK(QOIRoundTrips(MakeImage(1 + seed * 7 % 61, 1 + seed * 5 % 37, seed)));
+    }
+}
+
+// --- PNG ---
+
+static uint32_t Crc32(const uint8_t* data, size_t length)
+{
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Only what EncodePNG writes: 8-bit RGB, stored deflate blocks, filter None
+static bool DecodePNG(const std::vector<uint8_t>& data, int& width, int& height, std::vector<uint8_t>& rgb)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    if (data.size() < 8 || std::memcmp(data.data(), signature, 8) != 0) {
+        return false;
+    }
+    std::vector<uint8_t> zlib;
+    bool header = false, ended = false;
+    size_t p = 8;
+    while (!ended) {
+        if (p + 12 > data.size()) return false;
+        uint32_t length = GetBE32(&data[p]);
+        if (p + 12 + length > data.size() || Crc32(&data[p + 4], length + 4) != GetBE32(&data[p + 8 + length])) {
+            return false;
+        }
+        std::string type(reinterpret_cast<const char*>(&data[p + 4]), 4);
+        const uint8_t* body = &data[p + 8];
+        if (type == "IHDR") {
+            if (length != 13 || body[8] != 8 || body[9] != 2 || body[10] != 0 || body[11] != 0 || body[12] != 0) {
+                return false;
+            }
+            width = static_cast<int>(GetBE32(body));
+            height = static_cast<int>(GetBE32(body + 4));
+            header = true;
+        } else if (type == "IDAT") {
+            zlib.insert(zlib.end(), body, body + length);
+        } else if (type == "IEND") {
+            ended = true;
+        }
+        p += 12 + length;
+    }
+    if (!header || p != data.size() || zlib.size() < 6 || (zlib[0] << 8 | zlib[1]) % 31 != 0 || (zlib[0] & 0x0f) != 8) {
+        return false;
+    }
+
+    std::vector<uint8_t> raw;
+    size_t z = 2;
+    bool final = false;
+    while (!final) {
+        if (z + 5 > zlib.size() || (zlib[z] & 0x06) != 0) return false; // Stored blocks only
+        final = zlib[z] & 1;
+        uint16_t length = static_cast<uint16_t>(zlib[z + 1] | zlib[z + 2] << 8);
+        uint16_t inverse = static_cast<uint16_t>(zlib[z + 3] | zlib[z + 4] << 8);
+        z += 5;
+        if (static_cast<uint16_t>(~length) != inverse || z + length > zlib.size()) return false;
+        raw.insert(raw.end(), zlib.begin() + z, zlib.begin() + z + length);
+        z += length;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    if (z + 4 != zlib.size() || GetBE32(&zlib[z]) != (b << 16 | a)) {
+        return false;
+    }
+
+    const size_t rowBytes = static_cast<size_t>(width) * 3 + 1;
+    if (raw.size() != rowBytes * height) {
+        return false;
+    }
+    rgb.clear();
+    for (int y = 0; y < height; ++y) {
+        if (raw[y * rowBytes] != 0) return false;
+        rgb.insert(rgb.end(), raw.begin() + y * rowBytes + 1, raw.begin() + (y + 1) * rowBytes);
+    }
+    return true;
+}
+
+static void TestPNG()
+{
+    const int sizes[][2] = { { 1, 1 }, { 13, 7 }, { 200, 120 } }; // The last needs two stored blocks
+    for (const auto& size : sizes) {
+        Image image = MakeImage(size[0], size[1], static_cast<uint32_t>(size[0]));
+        std::vector<uint8_t> encoded;
+        EncodePNG(image.rgba.data(), image.width, image.height, encoded);
+        int width = 0, height = 0;
+        std::vector<uint8_t> rgb;
+        CHECK(DecodePNG(encoded, width, height, rgb));
+        CHECK(width == image.width && height == image.height && rgb == image.rgb());
+    }
+}
+
+// --- Y4M ---
+
+static void TestY4M()
+{
+    CHECK(Y4MHeader(320, 240, 30) == "YUV4MPEG2 W320 H240 F30:1 Ip A1:1 C420jpeg\n");
+
+    const int width = 7, height = 5; // Odd, so the last chroma samples clamp to the edge
+    Image image = MakeImage(width, height, 9);
+    std::vector<uint8_t> frame = { 'x' }; // Appended after what is already there
+    EncodeY4MFrame(image.rgba.data(), width, height, frame);
+    const int chromaWidth = 4, chromaHeight = 3;
+    CHECK(frame.size() == 1 + 6 + width * height + 2 * chromaWidth * chromaHeight);
+    CHECK(std::memcmp(&frame[1], "FRAME\n", 6) == 0);
+
+    const uint8_t* yPlane = &frame[7];
+    const uint8_t* uPlane = yPlane + width * height;
+    const uint8_t* vPlane = uPlane + chromaWidth * chromaHeight;
+    double worst = 0.0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* px = image.at(x, y);
+            double luma = 0.299 * px[0] + 0.587 * px[1] + 0.114 * px[2];
+            worst = std::max(worst, std::fabs(yPlane[y * width + x] - luma));
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; ++cy) {
+        for (int cx = 0; cx < chromaWidth; ++cx) {
+            double r = 0.0, g = 0.0, b = 0.0;
+            for (int dy = 0; dy < 2; ++dy) {
+                for (int dx = 0; dx < 2; ++dx) {
+                    const uint8_t* px = image.at(std::min(cx * 2 + dx, width - 1), std::min(cy * 2 + dy, height - 1));
+                    r += px[0] / 4.0; g += px[1] / 4.0; b += px[2] / 4.0;
+                }
+            }
+            double u = std::clamp(-0.168736 * r - 0.331264 * g + 0.5 * b + 128.0, 0.0, 255.0);
+            double v = std::clamp(0.5 * r - 0.418688 * g - 0.081312 * b + 128.0, 0.0, 255.0);
+            worst = std::max(worst, std::fabs(uPlane[cy * chromaWidth + cx] - u));
+            worst = std::max(worst, std::fabs(vPlane[cy * chromaWidth + cx] - v));
+        }
+    }
+    CHECK(worst <= 1.0);
+}
+
+int main()
+{
+    TestQOI();
+    TestPNG();
+    TestY4M();
+    return TestResult();
+}
@@ -0,0 +1,132 @@
+// Stress tests for the lock-free handoffs between threads: MpscQueue (operator
+// commands) and TripleBuffer (snapshots). Build with -DPGLMS_TSAN=ON to run
+// them under ThreadSanitizer.
+#include "mpsc_queue.h"
+#include "triple_buffer.h"
+#include "test_check.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+struct Tagged {
+    uint32_t producer = 0;
+    uint32_t sequence = 0;
+};
+
+static void TestQueueSingleThread()
+{
+    MpscQueue<int> queue(5);
+    CHECK(queue.capacity() == 8); // Rounded up to a power of two
+
+    int value = -1;
+    CHECK(!queue.pop(value));
+    for (int i = 0; i < 8; ++i) {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.push(8)); // Full: fails instead of blocking
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 8; ++i) {
+            CHECK(queue.pop(value) && value == lap * 8 + i);
+            CHECK(queue.push(lap * 8 + i + 8));
+        }
+    }
+}
+
+// Several producers against one consumer: nothing lost or duplicated, and
+// each producer's values arrive in the order it pushed them
+static void TestQueueProducers()
+{
+    const uint32_t producers = 4;
+    const uint32_t perProducer = 200000;
+    MpscQueue<Tagged> queue(64); // Small, so producers keep hitting the full case
+
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, &go, p, perProducer]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (uint32_t s = 0; s < perProducer; ++s) {
+                Tagged value;
+                value.producer = p;
+                value.sequence = s;
+                while (!queue.push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> expected(producers, 0);
+    uint64_t received = 0;
+    bool inOrder = true;
+    go.store(true);
+    while (received < static_cast<uint64_t>(producers) * perProducer) {
+        Tagged value;
+        if (!queue.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (value.producer >= producers || value.sequence != expected[value.producer]) {
+            inOrder = false;
+            break;
+        }
+        ++expected[value.producer];
+        ++received;
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK(inOrder);
+    Tagged extra;
+    CHECK(!queue.pop(extra));
+}
+
+// A slot the consumer holds is never written: every field of a value it
+// reads belongs to the same publish, and values never go backwards
+static void TestTripleBuffer()
+{
+    struct Frame {
+        uint64_t sequence = 0;
+        uint64_t copies[15] = {};
+    };
+    TripleBuffer<Frame> buffer;
+    const uint64_t frames = 500000;
+
+    std::thread producer([&buffer, frames]() {
+        for (uint64_t s = 1; s <= frames; ++s) {
+            Frame& frame = buffer.writeSlot();
+            frame.sequence = s;
+            for (uint64_t& copy : frame.copies) {
+                copy = s;
+            }
+            buffer.publish();
+        }
+    });
+
+    uint64_t last = 0;
+    bool consistent = true;
+    bool monotonic = true;
+    while (last < frames) {
+        const Frame& frame = buffer.acquire();
+        for (uint64_t copy : frame.copies) {
+            consistent = consistent && copy == frame.sequence;
+        }
+        monotonic = monotonic && frame.sequence >= last;
+        last = frame.sequence;
+    }
+    producer.join();
+    CHECK(consistent);
+    CHECK(monotonic);
+    CHECK(buffer.acquire().sequence == frames);
+}
+
+int main()
+{
+    TestQueueSingleThread();
+    TestQueueProducers();
+    TestTripleBuffer();
+    return TestResult();
+}
@@ -0,0 +1,178 @@
+// Load-shedding rules (shed_policy.h): parsing, constant folding, rejected
+// rules, and evaluate() against a direct per-zone evaluation.
+#include "shed_policy.h"
+#include "test_check.h"
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Inputs over enough zones for several evaluation blocks and a partial one
+struct Zones {
+    std::vector<float> load, maxLoad;
+    std::vector<uint8_t> priority, showPrompt;
+    std::vector<HouseState> state;
+    std::vector<double> stateChangeTime;
+    ShedPolicyInputs inputs;
+
+    explicit Zones(size_t count)
+        : load(count), maxLoad(count), priority(count), showPrompt(count), state(count), stateChangeTime(count)
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (size_t i = 0; i < count; ++i) {
+            maxLoad[i] = 0.5f + unit(rng);
+            load[i] = maxLoad[i] * 1.2f * unit(rng);
+            priority[i] = static_cast<uint8_t>(rng() % 4);
+            showPrompt[i] = rng() % 5 == 0 ? 1 : 0;
+            state[i] = static_cast<HouseState>(rng() % (COOLDOWN + 1));
+            stateChangeTime[i] = 30.0 * unit(rng);
+        }
+        inputs.count = count;
+        inputs.load = load.data();
+        inputs.maxLoad = maxLoad.data();
+        inputs.priority = priority.data();
+        inputs.state = state.data();
+        inputs.stateChangeTime = stateChangeTime.data();
+        inputs.showPrompt = showPrompt.data();
+        inputs.time = 31.5;
+        inputs.gridLoadRatio = 0.8f;
+    }
+};
+
+// Compile `rule` and compare evaluate() with `expected` zone by zone
+static bool SelectsLike(const char* rule, const Zones& zones, const std::function<bool(size_t, int)>& expected,
+                        int rotationGroups = 1)
+{
+    ShedPolicyConfig config;
+    config.rule = rule;
+    config.rotationGroups = rotationGroups;
+    config.rotationPeriod = 7.0;
+    ShedPolicy policy;
+    std::string error;
+    if (!policy.compile(config, error)) {
+        std::fprintf(stderr, "'%s' did not compile: %s\n", rule, error.c_str());
+        return false;
+    }
+    std::vector<float> scratch(policy.scratchBytes() / sizeof(float));
+    std::vector<int> selected(zones.inputs.count);
+    size_t count = policy.evaluate(zones.inputs, scratch.data(), selected.data());
+
+    std::vector<int> reference;
+    const int slot = policy.rotationSlot(zones.inputs.time);
+    for (size_t i = 0; i < zones.inputs.count; ++i) {
+        if (expected(i, slot)) {
+            reference.push_back(static_cast<int>(i));
+        }
+    }
+    selected.resize(count);
+    if (selected != reference) {
+        std::fprintf(stderr, "'%s' selected %zu zones, expected %zu\n", rule, count, reference.size());
+        return false;
+    }
+    return true;
+}
+
+static void TestEvaluate()
+{
+    const Zones z(600);
+    CHECK(SelectsLike("load > 0.9", z, [&](size_t i, int) { return z.load[i] > 0.9f; }));
+    CHECK(SelectsLike("load <= 0.5", z, [&](size_t i, int) { return z.load[i] <= 0.5f; }));
+    CHECK(SelectsLike("load_ratio >= 0.7 && priority != 0 || rotation", z, [&](size_t i, int slot) {
+        return (z.load[i] / z.maxLoad[i] >= 0.7f && z.priority[i] != 0) || static_cast<int>(i % 3) == slot;
+    }, 3));
+    CHECK(SelectsLike("state == OVERLOADED && !prompt && time_in_state > 5 - 1", z, [&](size_t i, int) {
+        return z.state[i] == OVERLOADED && !z.showPrompt[i] && static_cast<float>(z.inputs.time - z.stateChangeTime[i]) > 4.0f;
+    }));
+    CHECK(SelectsLike("(load - 0.5) * 2 > -max_load / 4 == !(priority < 1)", z, [&](size_t i, int) {
+        float left = (z.load[i] - 0.5f) * 2.0f > -z.maxLoad[i] / 4.0f ? 1.0f : 0.0f;
+        return left == (z.priority[i] < 1 ? 0.0f : 1.0f);
+    }));
+    CHECK(SelectsLike("grid_load_ratio > 0.75 && priority == 3", z, [&](size_t i, int) { return z.priority[i] == 3; }));
+    CHECK(SelectsLike("1 + 2 * 3 == 7", z, [](size_t, int) { return true; }));
+    CHECK(SelectsLike("false || !true", z, [](size_t, int) { return false; }));
+    CHECK(SelectsLike("-load < -1", z, [&](size_t i, int) { return -z.load[i] < -1.0f; }));
+}
+
+static size_t InstructionCount(const char* rule)
+{
+    ShedPolicyConfig config;
+    config.rule = rule;
+    ShedPolicy policy;
+    std::string error;
+    return policy.compile(config, error) ? policy.instructionCount() : 0;
+}
+
+// A constant right operand is folded into its operator as an immediate
+static void TestFolding()
+{
+    CHECK(InstructionCount("load > 0.9") == 2);                                      // load, > 0.9
+    CHECK(InstructionCount("load_ratio > 0.85 && priority >= 2 && rotation") == 7);  // Both compares fold
+    CHECK(InstructionCount("0.9 < load") == 3);                                      // Left constants stay
+    CHECK(InstructionCount("load * 2 + 1 > 3") == 4);                                // Chained immediates
+    CHECK(InstructionCount("-load < -1") == 5);                                      // Negate is not a constant
+
+    ShedPolicyConfig config;
+    config.rule = "load > 0.9";
+    ShedPolicy policy;
+    std::string error;
+    CHECK(policy.compile(config, error));
+    CHECK(policy.scratchBytes() == ShedPolicy::blockSize * sizeof(float));
+    config.rule = "(load + max_load) * (priority + state) > 1";
+    CHECK(policy.compile(config, error));
+    CHECK(policy.scratchBytes() == 3 * ShedPolicy::blockSize * sizeof(float)); // Two sums and a product
+}
+
+static void TestRejected()
+{
+    const char* rules[] = { "", "load >", "(load", "load > 0.9)", "foo > 1", "load & 1", "1 2", "load >> 1", "#" };
+    for (const char* rule : rules) {
+        ShedPolicyConfig config;
+        config.rule = rule;
+        ShedPolicy policy;
+        std::string error;
+        bool compiled = policy.compile(config, error);
+        CHECK(!compiled);
+        CHECK(error.find("column") != std::string::npos);
+        CHECK(policy.instructionCount() == 0);
+        if (compiled) {
+            std::fprintf(stderr, "'%s' should not compile\n", rule);
+        }
+    }
+
+    ShedPolicyConfig config;
+    config.rule = "load > 1";
+    ShedPolicy policy;
+    std::string error;
+    config.rotationGroups = 0;
+    CHECK(!policy.compile(config, error) && !error.empty());
+    config.rotationGroups = 2;
+    config.rotationPeriod = 0.0;
+    CHECK(!policy.compile(config, error));
+}
+
+static void TestRotation()
+{
+    ShedPolicyConfig config;
+    config.rule = "rotation";
+    config.rotationGroups = 3;
+    config.rotationPeriod = 7.0;
+    ShedPolicy policy;
+    std::string error;
+    CHECK(policy.compile(config, error));
+    CHECK(policy.rotationSlot(-5.0) == 0);
+    CHECK(policy.rotationSlot(0.0) == 0);
+    CHECK(policy.rotationSlot(6.9) == 0);
+    CHECK(policy.rotationSlot(7.0) == 1);
+    CHECK(policy.rotationSlot(20.9) == 2);
+    CHECK(policy.rotationSlot(21.0) == 0);
+}
+
+int main()
+{
+    TestEvaluate();
+    TestFolding();
+    TestRejected();
+    TestRotation();
+    return TestResult();
+}
@@ -0,0 +1,223 @@
+// Round trips of the packed telemetry stream (snapshot_codec.h): random
+// snapshot sequences through SnapshotEncoder and SnapshotDecoder, plus the
+// resync paths for a consumer that lost a delta.
+#include "snapshot_codec.h"
+#include "test_check.h"
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+struct Stream {
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<SimSnapshot> snapshots;
+    std::vector<bool> keyframes;
+};
+
+// `steps` snapshots of `zones` zones where a random few change per step,
+// encoded one frame per snapshot
+static Stream MakeStream(size_t zones, int steps, SnapshotCodecParams params, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    SnapshotEncoder encoder(params);
+    Stream stream;
+
+    SimSnapshot snapshot;
+    snapshot.currentLoad.resize(zones);
+    snapshot.state.resize(zones, NORMAL);
+    for (size_t i = 0; i < zones; ++i) {
+        snapshot.currentLoad[i] = 1.5f * unit(rng);
+    }
+    for (int s = 0; s < steps; ++s) {
+        snapshot.step = 10 + static_cast<uint64_t>(s) * 3; // Published batches skip steps
+        snapshot.time = snapshot.step * 0.001;
+        size_t changes = rng() % 20;
+        for (size_t c = 0; c < changes && zones > 0; ++c) {
+            size_t zone = rng() % zones;
+            snapshot.currentLoad[zone] = std::fmax(0.0f, snapshot.currentLoad[zone] + 0.2f * (unit(rng) - 0.5f));
+            if (rng() % 4 == 0) {
+                snapshot.state[zone] = static_cast<HouseState>(rng() % (COOLDOWN + 1));
+            }
+        }
+        std::vector<uint8_t> frame;
+        encoder.encode(snapshot, frame);
+        stream.frames.push_back(frame);
+        stream.snapshots.push_back(snapshot);
+        stream.keyframes.push_back(encoder.lastWasKeyframe());
+    }
+    return stream;
+}
+
+static bool Matches(const SnapshotDecoder& decoder, const SimSnapshot& snapshot, float quantum)
+{
+    if (decoder.step() != snapshot.step || decoder.time() != snapshot.time ||
+        decoder.state() != snapshot.state || decoder.load().size() != snapshot.currentLoad.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < snapshot.currentLoad.size(); ++i) {
+        if (std::fabs(decoder.load()[i] - snapshot.currentLoad[i]) > 0.5f * quantum + 1e-6f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void TestRoundTrip()
+{
+    const uint32_t seeds[] = { 1, 2, 3 };
+    const size_t zoneCounts[] = { 1, 37, 5000 };
+    for (uint32_t seed : seeds) {
+        for (size_t zones : zoneCounts) {
+            SnapshotCodecParams params;
+            params.keyframeInterval = 64;
+            Stream stream = MakeStream(zones, 300, params, seed);
+            SnapshotDecoder decoder;
+            bool applied = true;
+            bool matched = true;
+            for (size_t f = 0; f < stream.frames.size(); ++f) {
+                applied = applied && decoder.apply(stream.frames[f].data(), stream.frames[f].size());
+                matched = matched && Matches(decoder, stream.snapshots[f], params.loadQuantum);
+            }
+            CHECK(applied);
+            CHECK(matched);
+            CHECK(stream.keyframes[0] && stream.keyframes[64] && stream.keyframes[128] && !stream.keyframes[1]);
+        }
+    }
+}
+
+static void TestKeyframeSchedule()
+{
+    SnapshotCodecParams params;
+    params.keyframeInterval = 0; // Only the first
+    Stream stream = MakeStream(100, 200, params, 4);
+    size_t keyframes = 0;
+    for (bool keyframe : stream.keyframes) {
+        keyframes += keyframe ? 1 : 0;
+    }
+    CHECK(stream.keyframes[0] && keyframes == 1);
+
+    params.keyframeInterval = 1; // Every frame
+    stream = MakeStream(100, 20, params, 4);
+    for (bool keyframe : stream.keyframes) {
+        CHECK(keyframe);
+    }
+}
+
+// A decoder that misses a delta rejects the following ones (their base step
+// does not match) without changing state, and is back in sync at the next
+// keyframe, whether scheduled or sent on request
+static void TestDroppedDeltaResync()
+{
+    SnapshotCodecParams params;
+    params.keyframeInterval = 50;
+    Stream stream = MakeStream(800, 120, params, 5);
+    const size_t dropped = 10;
+    CHECK(!stream.keyframes[dropped]);
+
+    SnapshotDecoder decoder;
+    for (size_t f = 0; f < dropped; ++f) {
+        decoder.apply(stream.frames[f].data(), stream.frames[f].size());
+    }
+    bool rejected = true;
+    bool unchanged = true;
+    for (size_t f = dropped + 1; f < 50; ++f) {
+        rejected = rejected && !decoder.apply(stream.frames[f].data(), stream.frames[f].size());
+        unchanged = unchanged && Matches(decoder, stream.snapshots[dropped - 1], params.loadQuantum);
+    }
+    CHECK(rejected);
+    CHECK(unchanged);
+    CHECK(stream.keyframes[50]);
+    CHECK(decoder.apply(stream.frames[50].data(), stream.frames[50].size()));
+    bool matched = true;
+    for (size_t f = 51; f < stream.frames.size(); ++f) {
+        matched = matched && decoder.apply(stream.frames[f].data(), stream.frames[f].size()) &&
+                  Matches(decoder, stream.snapshots[f], params.loadQuantum);
+    }
+    CHECK(matched);
+
+    // appendKeyframe(): resync mid-interval, as the control server does for a coalesced client
+    std::mt19937 rng(6);
+    SnapshotEncoder encoder(params);
+    SnapshotDecoder late;
+    std::vector<uint8_t> keyframe;
+    CHECK(!encoder.appendKeyframe(keyframe)); // Nothing encoded yet
+    SimSnapshot snapshot;
+    snapshot.currentLoad.assign(300, 0.25f);
+    snapshot.state.assign(300, NORMAL);
+    matched = true;
+    for (int s = 1; s <= 30; ++s) {
+        snapshot.step = static_cast<uint64_t>(s);
+        snapshot.currentLoad[rng() % 300] += 0.01f;
+        std::vector<uint8_t> frame;
+        encoder.encode(snapshot, frame);
+        if (s == 12) {
+            keyframe.clear();
+            CHECK(encoder.appendKeyframe(keyframe));
+            CHECK(late.apply(keyframe.data(), keyframe.size()));
+        } else if (s > 12) {
+            matched = matched && late.apply(frame.data(), frame.size()) && Matches(late, snapshot, params.loadQuantum);
+        }
+    }
+    CHECK(matched);
+}
+
+static void TestMalformedFrames()
+{
+    SnapshotCodecParams params;
+    Stream stream = MakeStream(200, 3, params, 7);
+    SnapshotDecoder decoder;
+
+    // Deltas before any keyframe have nothing to apply to
+    CHECK(!decoder.apply(stream.frames[1].data(), stream.frames[1].size()));
+    CHECK(!decoder.synced());
+
+    const std::vector<uint8_t>& keyframe = stream.frames[0];
+    bool rejected = true;
+    for (size_t size = 0; size < keyframe.size(); size += 7) {
+        rejected = rejected && !decoder.apply(keyframe.data(), size);
+    }
+    CHECK(rejected);
+    CHECK(!decoder.synced());
+
+    CHECK(decoder.apply(keyframe.data(), keyframe.size()));
+    const std::vector<uint8_t>& delta = stream.frames[1];
+    CHECK(!decoder.apply(delta.data(), delta.size() / 2));
+    CHECK(Matches(decoder, stream.snapshots[0], params.loadQuantum));
+    CHECK(decoder.apply(delta.data(), delta.size()));
+    CHECK(Matches(decoder, stream.snapshots[1], params.loadQuantum));
+}
+
+// A changed zone count forces a keyframe
+static void TestZoneCountChange()
+{
+    SnapshotEncoder encoder;
+    SnapshotDecoder decoder;
+    SimSnapshot snapshot;
+    std::vector<uint8_t> frame;
+    bool matched = true;
+    for (int s = 1; s <= 6; ++s) {
+        size_t zones = s <= 3 ? 10 : 25;
+        snapshot.step = static_cast<uint64_t>(s);
+        snapshot.currentLoad.assign(zones, 0.1f * s);
+        snapshot.state.assign(zones, WARNING);
+        frame.clear();
+        encoder.encode(snapshot, frame);
+        if (s == 4) {
+            CHECK(encoder.lastWasKeyframe());
+        }
+        matched = matched && decoder.apply(frame.data(), frame.size()) &&
+                  Matches(decoder, snapshot, encoder.params().loadQuantum);
+    }
+    CHECK(matched);
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestKeyframeSchedule();
+    TestDroppedDeltaResync();
+    TestMalformedFrames();
+    TestZoneCountChange();
+    return TestResult();
+}
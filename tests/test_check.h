@@ -0,0 +1,28 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+// Minimal assertions for the CTest executables: a failed CHECK prints where
+// and what, and the test keeps going so one run reports every failure.
+// main() returns TestResult(), non-zero if anything failed.
+static int testFailures = 0;
+
+#define CHECK(condition)                                                                      \
+    do {                                                                                      \
+        if (!(condition)) {                                                                   \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++testFailures;                                                                   \
+        }                                                                                     \
+    } while (0)
+
+static int TestResult()
+{
+    if (testFailures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", testFailures);
+        return 1;
+    }
+    return 0;
+}
+
+#endif // TEST_CHECK_H